@@ -0,0 +1,33 @@
+#include <stddef.h>
+#include "bench.h"
+
+/**
+ * Counts allocations for the microbenchmarks. Programs using this are linked
+ * with -Wl,--wrap for each of these functions, which routes every call made
+ * outside of libc through here.
+ */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(const char *s);
+
+void *__wrap_malloc(size_t size) {
+	++bench_allocations;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+	++bench_allocations;
+	return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	++bench_allocations;
+	return __real_realloc(ptr, size);
+}
+
+char *__wrap_strdup(const char *s) {
+	++bench_allocations;
+	return __real_strdup(s);
+}
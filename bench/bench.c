@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 200809L
+#include <json-c/json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench.h"
+#include "log.h"
+
+#define BENCH_BUDGET 500000000 // ns
+
+size_t bench_allocations = 0;
+
+uint64_t bench_now_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void bench_samples_add(struct bench_samples *samples, double value) {
+	if (samples->length == samples->capacity) {
+		size_t capacity = samples->capacity ? samples->capacity * 2 : 64;
+		double *values = realloc(samples->values, capacity * sizeof(double));
+		if (!values) {
+			sway_abort("Unable to allocate benchmark samples");
+		}
+		samples->values = values;
+		samples->capacity = capacity;
+	}
+	samples->values[samples->length++] = value;
+}
+
+static int compare_double(const void *a, const void *b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static double percentile(struct bench_samples *samples, double p) {
+	size_t index = (size_t)(p * (samples->length - 1) + 0.5);
+	return samples->values[index];
+}
+
+json_object *bench_samples_summary(struct bench_samples *samples) {
+	json_object *summary = json_object_new_object();
+	json_object_object_add(summary, "count",
+			json_object_new_int64(samples->length));
+	if (samples->length == 0) {
+		return summary;
+	}
+
+	qsort(samples->values, samples->length, sizeof(double), compare_double);
+	double total = 0;
+	for (size_t i = 0; i < samples->length; ++i) {
+		total += samples->values[i];
+	}
+	json_object_object_add(summary, "min",
+			json_object_new_double(samples->values[0]));
+	json_object_object_add(summary, "mean",
+			json_object_new_double(total / samples->length));
+	json_object_object_add(summary, "median",
+			json_object_new_double(percentile(samples, 0.5)));
+	json_object_object_add(summary, "p99",
+			json_object_new_double(percentile(samples, 0.99)));
+	json_object_object_add(summary, "max",
+			json_object_new_double(samples->values[samples->length - 1]));
+	return summary;
+}
+
+void bench_samples_finish(struct bench_samples *samples) {
+	free(samples->values);
+	samples->values = NULL;
+	samples->length = samples->capacity = 0;
+}
+
+void bench_run(const char *name, void (*run)(void *data), void *data) {
+	// Warm up, then grow the batch until one takes a measurable time
+	run(data);
+	size_t batch = 1;
+	uint64_t elapsed;
+	while (true) {
+		uint64_t start = bench_now_ns();
+		for (size_t i = 0; i < batch; ++i) {
+			run(data);
+		}
+		elapsed = bench_now_ns() - start;
+		if (elapsed > BENCH_BUDGET / 100) {
+			break;
+		}
+		batch *= 2;
+	}
+
+	size_t iterations = batch * (BENCH_BUDGET / (elapsed + 1) + 1);
+	size_t allocations = bench_allocations;
+	uint64_t start = bench_now_ns();
+	for (size_t i = 0; i < iterations; ++i) {
+		run(data);
+	}
+	elapsed = bench_now_ns() - start;
+	allocations = bench_allocations - allocations;
+
+	printf("%-32s %12.1f ns/op %10.2f allocs/op\n", name,
+			(double)elapsed / iterations, (double)allocations / iterations);
+	fflush(stdout);
+}
@@ -0,0 +1,196 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "list.h"
+#include "readline.h"
+#include "stringop.h"
+#include "unicode.h"
+
+#define CONFIG_LINES 3000
+#define SORT_ITEMS 1000
+#define LIST_ITEMS 10000
+
+void sway_terminate(int exit_code) {
+	exit(exit_code);
+}
+
+static const char *bindsym_line = "bindsym $mod+Shift+e exec swaynag -t "
+	"warning -m 'You pressed the exit shortcut. Do you really want to exit "
+	"sway? This will end your Wayland session.' -b 'Yes, exit sway' "
+	"'swaymsg exit'";
+
+static const char *command_list = "[app_id=\"firefox\"] focus; "
+	"layout tabbed, move container to workspace number 2; "
+	"workspace number 2, exec \"notify-send 'moved; done'\"; "
+	"resize set width 640 px height 480 px; floating toggle, sticky enable";
+
+static const char *escaped = "exec notify-send \\\"Volume\\\" "
+	"\\\"$(pamixer --get-volume)%\\\" \\\\ \\t --hint=int:value:50";
+
+static const char *utf8_text = "Wörkspace 1: 编辑器 — ターミナル — Ελληνικά "
+	"— Русский — emoji 🙂🚀 — plain ascii to pad out the string a little";
+
+static void bench_split_args(void *data) {
+	int argc;
+	char **argv = split_args(bindsym_line, &argc);
+	free_argv(argc, argv);
+}
+
+/**
+ * Splits a command list the way execute_command does.
+ */
+static void bench_argsep(void *data) {
+	char buf[512];
+	memcpy(buf, command_list, strlen(command_list) + 1);
+	char *head = buf;
+	do {
+		char *cmdlist = argsep(&head, ";");
+		do {
+			argsep(&cmdlist, ",");
+		} while (cmdlist);
+	} while (head);
+}
+
+static void bench_cmdsep(void *data) {
+	char buf[512];
+	memcpy(buf, command_list, strlen(command_list) + 1);
+	char *head = buf;
+	do {
+		cmdsep(&head, ";,");
+	} while (head);
+}
+
+static void bench_unescape_string(void *data) {
+	char buf[256];
+	memcpy(buf, escaped, strlen(escaped) + 1);
+	unescape_string(buf);
+}
+
+static void bench_utf8_decode(void *data) {
+	const char *str = utf8_text;
+	uint32_t sum = 0;
+	while (*str) {
+		sum += utf8_decode(&str);
+	}
+	*(volatile uint32_t *)data = sum;
+}
+
+static int compare_ints(const void *a, const void *b) {
+	int x = **(const int **)a, y = **(const int **)b;
+	return (x > y) - (x < y);
+}
+
+struct sort_data {
+	int values[SORT_ITEMS];
+	void *shuffled[SORT_ITEMS];
+	list_t *list;
+};
+
+static void bench_list_stable_sort(void *data) {
+	struct sort_data *sort = data;
+	memcpy(sort->list->items, sort->shuffled, sizeof(sort->shuffled));
+	list_stable_sort(sort->list, compare_ints);
+}
+
+static void bench_list_add(void *data) {
+	list_t *list = create_list();
+	for (int i = 0; i < LIST_ITEMS; ++i) {
+		list_add(list, data);
+	}
+	list_free(list);
+}
+
+/**
+ * Copies a short list the way transactions snapshot a container's children.
+ */
+static void bench_list_copy(void *data) {
+	list_t *list = create_list();
+	list_cat(list, data);
+	list_free(list);
+}
+
+struct config_data {
+	char *text;
+	size_t size;
+};
+
+static void bench_read_line(void *data) {
+	struct config_data *config = data;
+	FILE *file = fmemopen(config->text, config->size, "r");
+	char *line;
+	while ((line = read_line(file))) {
+		free(line);
+	}
+	fclose(file);
+}
+
+/**
+ * A config of the size we see in practice: a block of variables, then
+ * bindings and rules using them.
+ */
+static void generate_config(struct config_data *config) {
+	FILE *file = open_memstream(&config->text, &config->size);
+	for (int i = 0; i < 200; ++i) {
+		fprintf(file, "set $var%d value-%d\n", i, i);
+	}
+	for (int i = 200; i < CONFIG_LINES; ++i) {
+		switch (i % 4) {
+		case 0:
+			fprintf(file, "bindsym $mod+Shift+%d move container to "
+					"workspace number %d\n", i, i % 10);
+			break;
+		case 1:
+			fprintf(file, "for_window [app_id=\"app%d\" title=\"^.*%d$\"] "
+					"floating enable, border pixel 2\n", i, i);
+			break;
+		case 2:
+			fprintf(file, "    # comment line %d explaining the next "
+					"block of the config\n", i);
+			break;
+		case 3:
+			fprintf(file, "exec_always $var%d --option=$var%d\n",
+					i % 200, (i * 7) % 200);
+			break;
+		}
+	}
+	fclose(file);
+}
+
+int main(int argc, char **argv) {
+	bench_run("split_args", bench_split_args, NULL);
+	bench_run("argsep", bench_argsep, NULL);
+	bench_run("cmdsep", bench_cmdsep, NULL);
+	bench_run("unescape_string", bench_unescape_string, NULL);
+
+	uint32_t sum;
+	bench_run("utf8_decode", bench_utf8_decode, &sum);
+
+	struct sort_data sort;
+	sort.list = create_list();
+	srand(1);
+	for (int i = 0; i < SORT_ITEMS; ++i) {
+		// Few distinct keys, so stability matters
+		sort.values[i] = rand() % 64;
+		sort.shuffled[i] = &sort.values[i];
+		list_add(sort.list, &sort.values[i]);
+	}
+	bench_run("list_stable_sort/1000", bench_list_stable_sort, &sort);
+	list_free(sort.list);
+
+	bench_run("list_add/10000", bench_list_add, &sum);
+	list_t *children = create_list();
+	for (int i = 0; i < 3; ++i) {
+		list_add(children, &sum);
+	}
+	bench_run("list_copy/3", bench_list_copy, children);
+	list_free(children);
+
+	struct config_data config;
+	generate_config(&config);
+	bench_run("read_line/3000", bench_read_line, &config);
+	free(config.text);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,367 @@
+#define _POSIX_C_SOURCE 200809L
+#include <getopt.h>
+#include <json-c/json.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench.h"
+#include "ipc-client.h"
+#include "log.h"
+
+#define STARTUP_TIMEOUT 10000 // ms
+#define VIEW_TIMEOUT 30000 // ms
+#define VIEW_POLL_MIN 5 // ms
+#define VIEW_POLL_MAX 200 // ms
+
+struct bench_options {
+	int outputs;
+	int iterations;
+	int views;
+	const char *config;
+	const char *client;
+};
+
+struct bench_state {
+	struct bench_options options;
+	pid_t sway_pid;
+	char socket_path[256];
+	int socketfd;
+	json_object *scenarios;
+};
+
+void sway_terminate(int exit_code) {
+	exit(exit_code);
+}
+
+static void sleep_ms(long ms) {
+	struct timespec ts = {
+		.tv_sec = ms / 1000,
+		.tv_nsec = (ms % 1000) * 1000000,
+	};
+	nanosleep(&ts, NULL);
+}
+
+static bool start_sway(struct bench_state *state) {
+	const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+	if (!runtime_dir) {
+		wlr_log(WLR_ERROR, "XDG_RUNTIME_DIR is not set");
+		return false;
+	}
+	snprintf(state->socket_path, sizeof(state->socket_path),
+			"%s/sway-bench.%d.sock", runtime_dir, getpid());
+	unlink(state->socket_path);
+
+	state->sway_pid = fork();
+	if (state->sway_pid < 0) {
+		wlr_log_errno(WLR_ERROR, "fork failed");
+		return false;
+	} else if (state->sway_pid == 0) {
+		char outputs[16];
+		snprintf(outputs, sizeof(outputs), "%d", state->options.outputs);
+		setenv("WLR_BACKENDS", "headless", true);
+		setenv("WLR_HEADLESS_OUTPUTS", outputs, true);
+		setenv("WLR_LIBINPUT_NO_DEVICES", "1", true);
+		setenv("SWAYSOCK", state->socket_path, true);
+		execlp("sway", "sway", "-c", state->options.config, NULL);
+		_exit(EXIT_FAILURE);
+	}
+
+	for (int waited = 0; waited < STARTUP_TIMEOUT; waited += 10) {
+		if (access(state->socket_path, F_OK) == 0) {
+			state->socketfd = ipc_open_socket(state->socket_path);
+			return true;
+		}
+		if (waitpid(state->sway_pid, NULL, WNOHANG) == state->sway_pid) {
+			wlr_log(WLR_ERROR, "sway exited during startup");
+			state->sway_pid = -1;
+			return false;
+		}
+		sleep_ms(10);
+	}
+	wlr_log(WLR_ERROR, "Timed out waiting for %s", state->socket_path);
+	return false;
+}
+
+/**
+ * Stops sway with SIGTERM. The exit command can't be used, because sway closes
+ * the socket before it sends the reply.
+ */
+static void stop_sway(struct bench_state *state) {
+	if (state->socketfd >= 0) {
+		close(state->socketfd);
+		state->socketfd = -1;
+	}
+	if (state->sway_pid <= 0) {
+		return;
+	}
+	kill(state->sway_pid, SIGTERM);
+	for (int waited = 0; waited < STARTUP_TIMEOUT; waited += 10) {
+		if (waitpid(state->sway_pid, NULL, WNOHANG) == state->sway_pid) {
+			state->sway_pid = -1;
+			return;
+		}
+		sleep_ms(10);
+	}
+	kill(state->sway_pid, SIGKILL);
+	waitpid(state->sway_pid, NULL, 0);
+	state->sway_pid = -1;
+}
+
+/**
+ * Sends an IPC message and returns how long the reply took, in milliseconds.
+ */
+static double timed_message(struct bench_state *state, uint32_t type,
+		const char *payload, char **reply) {
+	uint32_t len = strlen(payload);
+	uint64_t start = bench_now_ns();
+	char *resp = ipc_single_command(state->socketfd, type, payload, &len);
+	double ms = (bench_now_ns() - start) / 1000000.0;
+	if (reply) {
+		*reply = resp;
+	} else {
+		free(resp);
+	}
+	return ms;
+}
+
+static void add_scenario(struct bench_state *state, const char *name,
+		struct bench_samples *ipc, double total_ms) {
+	json_object *scenario = json_object_new_object();
+	json_object_object_add(scenario, "name", json_object_new_string(name));
+	json_object_object_add(scenario, "total_ms",
+			json_object_new_double(total_ms));
+	json_object_object_add(scenario, "ipc_ms", bench_samples_summary(ipc));
+	json_object_array_add(state->scenarios, scenario);
+	bench_samples_finish(ipc);
+}
+
+/**
+ * Runs each command in turn, repeated for the configured iterations.
+ */
+static void run_commands(struct bench_state *state, const char *name,
+		const char *commands[], size_t ncommands) {
+	struct bench_samples ipc = {0};
+	uint64_t start = bench_now_ns();
+	for (int i = 0; i < state->options.iterations; ++i) {
+		const char *command = commands[i % ncommands];
+		bench_samples_add(&ipc,
+				timed_message(state, IPC_COMMAND, command, NULL));
+	}
+	add_scenario(state, name, &ipc, (bench_now_ns() - start) / 1000000.0);
+}
+
+static int count_views(json_object *node) {
+	int count = json_object_object_get_ex(node, "pid", NULL) ? 1 : 0;
+	const char *keys[] = { "nodes", "floating_nodes" };
+	for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+		json_object *children;
+		if (!json_object_object_get_ex(node, keys[i], &children)) {
+			continue;
+		}
+		size_t len = json_object_array_length(children);
+		for (size_t j = 0; j < len; ++j) {
+			count += count_views(json_object_array_get_idx(children, j));
+		}
+	}
+	return count;
+}
+
+static int get_view_count(struct bench_state *state, struct bench_samples *ipc) {
+	char *reply = NULL;
+	bench_samples_add(ipc, timed_message(state, IPC_GET_TREE, "", &reply));
+	json_object *tree = json_tokener_parse(reply);
+	free(reply);
+	int count = tree ? count_views(tree) : 0;
+	json_object_put(tree);
+	return count;
+}
+
+/**
+ * Launches the views and waits for them all to map. The exec commands are
+ * reported as the scenario's IPC timings; the get_tree polls used to count
+ * mapped views are backed off so they don't load the compositor being
+ * measured, and are left out.
+ */
+static bool open_views(struct bench_state *state) {
+	struct bench_samples ipc = {0}, polls = {0};
+	char *command = malloc(strlen("exec ") + strlen(state->options.client) + 1);
+	sprintf(command, "exec %s", state->options.client);
+
+	uint64_t start = bench_now_ns();
+	for (int i = 0; i < state->options.views; ++i) {
+		bench_samples_add(&ipc,
+				timed_message(state, IPC_COMMAND, command, NULL));
+	}
+	free(command);
+
+	int count = 0;
+	long backoff = VIEW_POLL_MIN;
+	while ((count = get_view_count(state, &polls)) < state->options.views) {
+		if ((bench_now_ns() - start) / 1000000 > VIEW_TIMEOUT) {
+			wlr_log(WLR_ERROR, "Only %d of %d views mapped",
+					count, state->options.views);
+			bench_samples_finish(&ipc);
+			bench_samples_finish(&polls);
+			return false;
+		}
+		sleep_ms(backoff);
+		if (backoff < VIEW_POLL_MAX) {
+			backoff *= 2;
+		}
+	}
+	bench_samples_finish(&polls);
+	add_scenario(state, "open-views", &ipc,
+			(bench_now_ns() - start) / 1000000.0);
+	return true;
+}
+
+static void run_scenarios(struct bench_state *state) {
+	const char *workspaces[] = {
+		"workspace number 1", "workspace number 2", "workspace number 3",
+		"workspace number 4", "workspace number 5",
+	};
+	const char *layouts[] = {
+		"layout tabbed", "layout stacking", "layout splith", "layout splitv",
+	};
+	const char *resizes[] = {
+		"resize grow width 10px", "resize shrink width 10px",
+		"resize grow height 10px", "resize shrink height 10px",
+	};
+	// Reorders the focused workspace's children, so each command copies
+	// their lists into a transaction and arranges the whole workspace
+	const char *moves[] = {
+		"move left", "move right", "move up", "move down",
+	};
+	// Re-renders every title texture each time, as clients spamming
+	// set_title would, without needing a client that does so
+	const char *titles[] = {
+		"[all] title_format \"%title\"",
+		"[all] title_format \"%title (%app_id)\"",
+		"[all] title_format \"<b>%title</b>\"",
+		"[all] title_format \"%title - %shell\"",
+	};
+	const char *nops[] = { "nop" };
+
+	if (state->options.client && !open_views(state)) {
+		return;
+	}
+	run_commands(state, "layout-churn", layouts,
+			sizeof(layouts) / sizeof(layouts[0]));
+	run_commands(state, "move-churn", moves,
+			sizeof(moves) / sizeof(moves[0]));
+	run_commands(state, "resize", resizes,
+			sizeof(resizes) / sizeof(resizes[0]));
+	run_commands(state, "title-churn", titles,
+			sizeof(titles) / sizeof(titles[0]));
+	run_commands(state, "nop", nops, 1);
+	run_commands(state, "workspace-switch", workspaces,
+			sizeof(workspaces) / sizeof(workspaces[0]));
+
+	struct bench_samples ipc = {0};
+	uint64_t start = bench_now_ns();
+	for (int i = 0; i < state->options.iterations; ++i) {
+		get_view_count(state, &ipc);
+	}
+	add_scenario(state, "get-tree", &ipc,
+			(bench_now_ns() - start) / 1000000.0);
+}
+
+int main(int argc, char **argv) {
+	static struct option long_options[] = {
+		{"help", no_argument, NULL, 'h'},
+		{"client", required_argument, NULL, 'C'},
+		{"config", required_argument, NULL, 'c'},
+		{"iterations", required_argument, NULL, 'i'},
+		{"outputs", required_argument, NULL, 'o'},
+		{"views", required_argument, NULL, 'n'},
+		{0, 0, 0, 0}
+	};
+
+	const char *usage =
+		"Usage: sway-bench [options]\n"
+		"\n"
+		"Runs sway on the headless backend, drives it over IPC and prints a\n"
+		"JSON report of the timings.\n"
+		"\n"
+		"  -h, --help              Show help message and quit.\n"
+		"  -C, --client <command>  Client to open views with.\n"
+		"  -c, --config <path>     Config to run sway with.\n"
+		"  -i, --iterations <n>    Commands per scenario (default 1000).\n"
+		"  -o, --outputs <n>       Number of headless outputs (default 1).\n"
+		"  -n, --views <n>         Views to open with --client (default 500).\n";
+
+	struct bench_state state = {
+		.options = {
+			.outputs = 1,
+			.iterations = 1000,
+			.views = 500,
+			.config = "/dev/null",
+		},
+		.sway_pid = -1,
+		.socketfd = -1,
+	};
+
+	int c;
+	while (1) {
+		int option_index = 0;
+		c = getopt_long(argc, argv, "hC:c:i:o:n:", long_options, &option_index);
+		if (c == -1) {
+			break;
+		}
+		switch (c) {
+		case 'C':
+			state.options.client = optarg;
+			break;
+		case 'c':
+			state.options.config = optarg;
+			break;
+		case 'i':
+			state.options.iterations = atoi(optarg);
+			break;
+		case 'o':
+			state.options.outputs = atoi(optarg);
+			break;
+		case 'n':
+			state.options.views = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "%s", usage);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (state.options.iterations <= 0 || state.options.outputs <= 0 ||
+			state.options.views <= 0) {
+		fprintf(stderr, "%s", usage);
+		exit(EXIT_FAILURE);
+	}
+
+	wlr_log_init(WLR_ERROR, NULL);
+
+	if (!start_sway(&state)) {
+		stop_sway(&state);
+		return EXIT_FAILURE;
+	}
+
+	state.scenarios = json_object_new_array();
+	run_scenarios(&state);
+
+	// Report before stopping sway, so a failure there can't lose the results
+	json_object *report = json_object_new_object();
+	json_object_object_add(report, "outputs",
+			json_object_new_int(state.options.outputs));
+	json_object_object_add(report, "iterations",
+			json_object_new_int(state.options.iterations));
+	json_object_object_add(report, "scenarios", state.scenarios);
+	printf("%s\n", json_object_to_json_string_ext(report,
+				JSON_C_TO_STRING_PRETTY | JSON_C_TO_STRING_SPACED));
+	fflush(stdout);
+	json_object_put(report);
+
+	stop_sway(&state);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sway/commands.h"
+#include "sway/config.h"
+#include "sway/criteria.h"
+#include "sway/server.h"
+#include "bench.h"
+#include "list.h"
+
+#define VARIABLES 200
+
+struct sway_server server;
+
+void sway_terminate(int exit_code) {
+	exit(exit_code);
+}
+
+static const char *criteria_string = "[app_id=\"^(firefox|chromium)$\" "
+	"title=\"^.* - Mozilla Firefox$\" con_mark=\"browser\" floating]";
+
+static void bench_do_var_replacement(void *data) {
+	const char *line = data;
+	free(do_var_replacement(strdup(line)));
+}
+
+static void bench_criteria_parse(void *data) {
+	char *error = NULL;
+	struct criteria *criteria = criteria_parse((char *)criteria_string, &error);
+	if (criteria) {
+		criteria_destroy(criteria);
+	}
+	free(error);
+}
+
+int main(int argc, char **argv) {
+	// Only the parts of the config these parsers look at
+	config = calloc(1, sizeof(struct sway_config));
+	config->symbols = create_list();
+	for (int i = 0; i < VARIABLES; ++i) {
+		char name[32], value[64];
+		snprintf(name, sizeof(name), "$var%d", i);
+		snprintf(value, sizeof(value), "value-of-variable-%d", i);
+		char *set_argv[] = { name, value };
+		free_cmd_results(cmd_set(2, set_argv));
+	}
+
+	bench_run("do_var_replacement/none", bench_do_var_replacement,
+			"bindsym Mod4+Shift+e exec swaynag -t warning -m 'Exit sway?'");
+	bench_run("do_var_replacement/3", bench_do_var_replacement,
+			"bindsym $var1+$var150 exec $var199 --flag=$var42");
+
+	bench_run("criteria_parse", bench_criteria_parse, NULL);
+
+	for (int i = 0; i < config->symbols->length; ++i) {
+		free_sway_variable(config->symbols->items[i]);
+	}
+	list_free(config->symbols);
+	free(config);
+	return EXIT_SUCCESS;
+}
@@ -1,4 +1,4 @@
-#define _POSIX_C_SOURCE 200809
+#define _GNU_SOURCE
 #include <assert.h>
 #include <cairo/cairo.h>
 #include <fcntl.h>
@@ -12,6 +12,29 @@
 #include "config.h"
 #include "pool-buffer.h"
 
+/**
+ * Buffers are sub-allocated from one wl_shm_pool per wl_shm. The pool's
+ * address space is reserved up front so it can grow in place without moving
+ * the buffers already allocated from it; only if the reservation runs out is
+ * another pool created.
+ */
+struct shm_pool {
+	struct wl_list link; // pools
+	struct wl_shm *shm;
+	struct wl_shm_pool *pool;
+	int fd;
+	void *data;
+	size_t size; // Bytes backed by the file
+	size_t reserved; // Bytes of address space reserved at data
+	struct wl_list buffers; // pool_buffer::link, sorted by offset
+};
+
+static const size_t POOL_RESERVED_SIZE =
+	sizeof(void *) > 4 ? (size_t)1 << 30 : (size_t)64 << 20;
+
+static struct wl_list pools;
+static bool pools_initialized = false;
+
 static bool set_cloexec(int fd) {
 	long flags = fcntl(fd, F_GETFD);
 	if (flags == -1) {
@@ -25,7 +48,16 @@ static bool set_cloexec(int fd) {
 	return true;
 }
 
-static int create_pool_file(size_t size, char **name) {
+static int create_pool_file(void) {
+#ifdef HAVE_MEMFD_CREATE
+	int memfd = memfd_create("sway-client", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (memfd >= 0) {
+		// The pool grows, but the compositor must never see it shrink
+		fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK);
+		return memfd;
+	}
+#endif
+
 	static const char template[] = "sway-client-XXXXXX";
 	const char *path = getenv("XDG_RUNTIME_DIR");
 	if (path == NULL) {
@@ -34,14 +66,18 @@ static int create_pool_file(size_t size, char **name) {
 	}
 
 	size_t name_size = strlen(template) + 1 + strlen(path) + 1;
-	*name = malloc(name_size);
-	if (*name == NULL) {
+	char *name = malloc(name_size);
+	if (name == NULL) {
 		fprintf(stderr, "allocation failed\n");
 		return -1;
 	}
-	snprintf(*name, name_size, "%s/%s", path, template);
+	snprintf(name, name_size, "%s/%s", path, template);
 
-	int fd = mkstemp(*name);
+	int fd = mkstemp(name);
+	if (fd >= 0) {
+		unlink(name);
+	}
+	free(name);
 	if (fd < 0) {
 		return -1;
 	}
@@ -51,12 +87,130 @@ static int create_pool_file(size_t size, char **name) {
 		return -1;
 	}
 
-	if (ftruncate(fd, size) < 0) {
-		close(fd);
-		return -1;
+	return fd;
+}
+
+static void shm_pool_destroy(struct shm_pool *pool) {
+	wl_list_remove(&pool->link);
+	if (pool->pool) {
+		wl_shm_pool_destroy(pool->pool);
 	}
+	munmap(pool->data, pool->reserved);
+	close(pool->fd);
+	free(pool);
+}
 
-	return fd;
+static struct shm_pool *shm_pool_create(struct wl_shm *shm, size_t size) {
+	struct shm_pool *pool = calloc(1, sizeof(struct shm_pool));
+	if (!pool) {
+		return NULL;
+	}
+	pool->shm = shm;
+	pool->reserved = size > POOL_RESERVED_SIZE ? size : POOL_RESERVED_SIZE;
+	wl_list_init(&pool->buffers);
+
+	pool->fd = create_pool_file();
+	if (pool->fd < 0) {
+		free(pool);
+		return NULL;
+	}
+	pool->data = mmap(NULL, pool->reserved, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (pool->data == MAP_FAILED) {
+		close(pool->fd);
+		free(pool);
+		return NULL;
+	}
+	wl_list_insert(&pools, &pool->link);
+
+	if (ftruncate(pool->fd, size) < 0 ||
+			mmap(pool->data, size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_FIXED, pool->fd, 0) == MAP_FAILED) {
+		shm_pool_destroy(pool);
+		return NULL;
+	}
+	pool->size = size;
+	pool->pool = wl_shm_create_pool(shm, pool->fd, size);
+	return pool;
+}
+
+static bool shm_pool_grow(struct shm_pool *pool, size_t size) {
+	if (size <= pool->size) {
+		return true;
+	}
+	// Grow geometrically to keep resizes rare
+	if (size < pool->size * 2) {
+		size = pool->size * 2 < pool->reserved ?
+			pool->size * 2 : pool->reserved;
+	}
+	if (ftruncate(pool->fd, size) < 0) {
+		return false;
+	}
+	// Mapping over the old range keeps existing buffers at the same address
+	if (mmap(pool->data, size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_FIXED, pool->fd, 0) == MAP_FAILED) {
+		return false;
+	}
+	wl_shm_pool_resize(pool->pool, size);
+	pool->size = size;
+	return true;
+}
+
+/**
+ * Finds the first gap in a pool big enough for size bytes and links the
+ * buffer into it, growing the pool if the gap is at the end.
+ */
+static bool shm_pool_alloc(struct shm_pool *pool, struct pool_buffer *buf,
+		size_t size) {
+	size_t offset = 0;
+	struct wl_list *prev = &pool->buffers;
+	struct pool_buffer *iter;
+	wl_list_for_each(iter, &pool->buffers, link) {
+		if (iter->offset - offset >= size) {
+			break;
+		}
+		offset = iter->offset + iter->size;
+		prev = &iter->link;
+	}
+	if (offset + size > pool->reserved ||
+			!shm_pool_grow(pool, offset + size)) {
+		return false;
+	}
+	buf->pool = pool;
+	buf->offset = offset;
+	buf->size = size;
+	buf->data = (char *)pool->data + offset;
+	wl_list_insert(prev, &buf->link);
+	return true;
+}
+
+static bool buffer_alloc(struct wl_shm *shm, struct pool_buffer *buf,
+		size_t size) {
+	if (!pools_initialized) {
+		wl_list_init(&pools);
+		pools_initialized = true;
+	}
+	struct shm_pool *pool;
+	wl_list_for_each(pool, &pools, link) {
+		if (pool->shm == shm && shm_pool_alloc(pool, buf, size)) {
+			return true;
+		}
+	}
+	pool = shm_pool_create(shm, size);
+	return pool && shm_pool_alloc(pool, buf, size);
+}
+
+static void buffer_free(struct pool_buffer *buf) {
+	if (!buf->pool) {
+		return;
+	}
+	wl_list_remove(&buf->link);
+	if (wl_list_empty(&buf->pool->buffers)) {
+		shm_pool_destroy(buf->pool);
+	}
+	buf->pool = NULL;
+	buf->data = NULL;
+	buf->size = 0;
 }
 
 static void buffer_release(void *data, struct wl_buffer *wl_buffer) {
@@ -68,30 +222,46 @@ static const struct wl_buffer_listener buffer_listener = {
 	.release = buffer_release
 };
 
+// Destroys everything but the buffer's allocation in the pool
+static void destroy_buffer_surfaces(struct pool_buffer *buffer) {
+	if (buffer->buffer) {
+		wl_buffer_destroy(buffer->buffer);
+		buffer->buffer = NULL;
+	}
+	if (buffer->cairo) {
+		cairo_destroy(buffer->cairo);
+		buffer->cairo = NULL;
+	}
+	if (buffer->surface) {
+		cairo_surface_destroy(buffer->surface);
+		buffer->surface = NULL;
+	}
+	if (buffer->pango) {
+		g_object_unref(buffer->pango);
+		buffer->pango = NULL;
+	}
+}
+
 static struct pool_buffer *create_buffer(struct wl_shm *shm,
 		struct pool_buffer *buf, int32_t width, int32_t height,
 		uint32_t format) {
 	uint32_t stride = width * 4;
 	size_t size = stride * height;
 
-	char *name;
-	int fd = create_pool_file(size, &name);
-	assert(fd != -1);
-	void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-	struct wl_shm_pool *pool = wl_shm_create_pool(shm, fd, size);
-	buf->buffer = wl_shm_pool_create_buffer(pool, 0,
-			width, height, stride, format);
-	wl_shm_pool_destroy(pool);
-	close(fd);
-	unlink(name);
-	free(name);
-	fd = -1;
+	// Reuse the buffer's space in the pool if the new size fits
+	destroy_buffer_surfaces(buf);
+	if (buf->pool && buf->size < size) {
+		buffer_free(buf);
+	}
+	if (!buf->pool && !buffer_alloc(shm, buf, size)) {
+		return NULL;
+	}
 
-	buf->size = size;
+	buf->buffer = wl_shm_pool_create_buffer(buf->pool->pool, buf->offset,
+			width, height, stride, format);
 	buf->width = width;
 	buf->height = height;
-	buf->data = data;
-	buf->surface = cairo_image_surface_create_for_data(data,
+	buf->surface = cairo_image_surface_create_for_data(buf->data,
 			CAIRO_FORMAT_ARGB32, width, height, stride);
 	buf->cairo = cairo_create(buf->surface);
 	buf->pango = pango_cairo_create_context(buf->cairo);
@@ -101,44 +271,35 @@ static struct pool_buffer *create_buffer(struct wl_shm *shm,
 }
 
 void destroy_buffer(struct pool_buffer *buffer) {
-	if (buffer->buffer) {
-		wl_buffer_destroy(buffer->buffer);
-	}
-	if (buffer->cairo) {
-		cairo_destroy(buffer->cairo);
-	}
-	if (buffer->surface) {
-		cairo_surface_destroy(buffer->surface);
-	}
-	if (buffer->pango) {
-		g_object_unref(buffer->pango);
-	}
-	if (buffer->data) {
-		munmap(buffer->data, buffer->size);
-	}
+	destroy_buffer_surfaces(buffer);
+	buffer_free(buffer);
 	memset(buffer, 0, sizeof(struct pool_buffer));
 }
 
 struct pool_buffer *get_next_buffer(struct wl_shm *shm,
-		struct pool_buffer pool[static 2], uint32_t width, uint32_t height) {
+		struct pool_buffer pool[static POOL_BUFFER_COUNT],
+		uint32_t width, uint32_t height) {
 	struct pool_buffer *buffer = NULL;
 
-	for (size_t i = 0; i < 2; ++i) {
-		if (pool[i].busy) {
-			continue;
+	// The last buffer is only used while all the others are busy
+	for (size_t i = 0; i < POOL_BUFFER_COUNT; ++i) {
+		if (!pool[i].busy) {
+			buffer = &pool[i];
+			break;
 		}
-		buffer = &pool[i];
 	}
 
 	if (!buffer) {
 		return NULL;
 	}
 
-	if (buffer->width != width || buffer->height != height) {
-		destroy_buffer(buffer);
+	struct pool_buffer *spare = &pool[POOL_BUFFER_COUNT - 1];
+	if (buffer != spare && spare->buffer && !spare->busy) {
+		destroy_buffer(spare);
 	}
 
-	if (!buffer->buffer) {
+	if (!buffer->buffer || buffer->width != width ||
+			buffer->height != height) {
 		if (!create_buffer(shm, buffer, width, height,
 					WL_SHM_FORMAT_ARGB8888)) {
 			return NULL;
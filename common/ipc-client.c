@@ -1,9 +1,13 @@
 #define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 #include "ipc-client.h"
@@ -108,19 +112,49 @@ void free_ipc_response(struct ipc_response *response) {
 	free(response);
 }
 
-char *ipc_single_command(int socketfd, uint32_t type, const char *payload, uint32_t *len) {
-	char data[ipc_header_size];
-	uint32_t *data32 = (uint32_t *)(data + sizeof(ipc_magic));
-	memcpy(data, ipc_magic, sizeof(ipc_magic));
-	memcpy(&data32[0], len, sizeof(*len));
-	memcpy(&data32[1], &type, sizeof(type));
+static void fill_header(char *header, uint32_t type, uint32_t len) {
+	uint32_t *header32 = (uint32_t *)(header + sizeof(ipc_magic));
+	memcpy(header, ipc_magic, sizeof(ipc_magic));
+	memcpy(&header32[0], &len, sizeof(len));
+	memcpy(&header32[1], &type, sizeof(type));
+}
 
-	if (write(socketfd, data, ipc_header_size) == -1) {
-		sway_abort("Unable to send IPC header");
+/**
+ * Writes what it can of the iovecs, advancing them past what was written.
+ * Returns the number of bytes written, or -1 on error. A closed socket fails
+ * with EPIPE rather than raising SIGPIPE in the client.
+ */
+static ssize_t write_iov(int fd, struct iovec *iov, int iovcnt) {
+	struct msghdr msg = {
+		.msg_iov = iov,
+		.msg_iovlen = iovcnt,
+	};
+	ssize_t written = sendmsg(fd, &msg, MSG_NOSIGNAL);
+	if (written <= 0) {
+		return written;
+	}
+	size_t left = written;
+	for (int i = 0; i < iovcnt; ++i) {
+		size_t n = left < iov[i].iov_len ? left : iov[i].iov_len;
+		iov[i].iov_base = (char *)iov[i].iov_base + n;
+		iov[i].iov_len -= n;
+		left -= n;
 	}
+	return written;
+}
+
+char *ipc_single_command(int socketfd, uint32_t type, const char *payload, uint32_t *len) {
+	char header[ipc_header_size];
+	fill_header(header, type, *len);
 
-	if (write(socketfd, payload, *len) == -1) {
-		sway_abort("Unable to send IPC payload");
+	struct iovec iov[2] = {
+		{ .iov_base = header, .iov_len = ipc_header_size },
+		{ .iov_base = (void *)payload, .iov_len = *len },
+	};
+	while (iov[0].iov_len + iov[1].iov_len > 0) {
+		if (write_iov(socketfd, iov, 2) == -1 && errno != EINTR) {
+			sway_abort("Unable to send IPC message");
+		}
 	}
 
 	struct ipc_response *resp = ipc_recv_response(socketfd);
@@ -130,3 +164,279 @@ char *ipc_single_command(int socketfd, uint32_t type, const char *payload, uint3
 
 	return response;
 }
+
+struct ipc_pending_reply {
+	ipc_response_func callback;
+	void *data;
+};
+
+struct ipc_connection {
+	int fd;
+	bool failed;
+
+	ipc_response_func on_event;
+	void *event_data;
+
+	// Bytes of requests not yet accepted by the socket
+	char *out;
+	size_t out_len, out_size;
+
+	// Bytes received but not yet dispatched
+	char *in;
+	size_t in_len, in_size;
+
+	// Ring buffer of callbacks for requests awaiting their reply
+	struct ipc_pending_reply *pending;
+	int pending_head, pending_count, pending_size;
+};
+
+struct ipc_connection *ipc_connection_create(int socketfd,
+		ipc_response_func on_event, void *data) {
+	int flags = fcntl(socketfd, F_GETFL);
+	if (flags == -1 || fcntl(socketfd, F_SETFL, flags | O_NONBLOCK) == -1) {
+		wlr_log_errno(WLR_ERROR, "Unable to make IPC socket non-blocking");
+		return NULL;
+	}
+	struct ipc_connection *conn = calloc(1, sizeof(struct ipc_connection));
+	if (!conn) {
+		wlr_log(WLR_ERROR, "Unable to allocate IPC connection");
+		return NULL;
+	}
+	conn->fd = socketfd;
+	conn->on_event = on_event;
+	conn->event_data = data;
+	return conn;
+}
+
+void ipc_connection_destroy(struct ipc_connection *conn) {
+	if (!conn) {
+		return;
+	}
+	close(conn->fd);
+	free(conn->out);
+	free(conn->in);
+	free(conn->pending);
+	free(conn);
+}
+
+int ipc_connection_get_fd(struct ipc_connection *conn) {
+	return conn->fd;
+}
+
+int ipc_connection_pending(struct ipc_connection *conn) {
+	return conn->pending_count;
+}
+
+static bool buffer_reserve(char **buf, size_t *size, size_t needed) {
+	if (needed <= *size) {
+		return true;
+	}
+	size_t new_size = *size ? *size : 4096;
+	while (new_size < needed) {
+		new_size *= 2;
+	}
+	char *new_buf = realloc(*buf, new_size);
+	if (!new_buf) {
+		wlr_log(WLR_ERROR, "Unable to grow IPC buffer");
+		return false;
+	}
+	*buf = new_buf;
+	*size = new_size;
+	return true;
+}
+
+static bool pending_push(struct ipc_connection *conn,
+		ipc_response_func callback, void *data) {
+	if (conn->pending_count == conn->pending_size) {
+		int size = conn->pending_size ? conn->pending_size * 2 : 16;
+		struct ipc_pending_reply *pending =
+			malloc(sizeof(struct ipc_pending_reply) * size);
+		if (!pending) {
+			wlr_log(WLR_ERROR, "Unable to grow IPC reply queue");
+			return false;
+		}
+		// Unwrap the ring into the start of the new array
+		for (int i = 0; i < conn->pending_count; ++i) {
+			pending[i] = conn->pending[
+				(conn->pending_head + i) % conn->pending_size];
+		}
+		free(conn->pending);
+		conn->pending = pending;
+		conn->pending_head = 0;
+		conn->pending_size = size;
+	}
+	int tail = (conn->pending_head + conn->pending_count) % conn->pending_size;
+	conn->pending[tail].callback = callback;
+	conn->pending[tail].data = data;
+	conn->pending_count++;
+	return true;
+}
+
+static bool flush_output(struct ipc_connection *conn) {
+	while (conn->out_len > 0) {
+		ssize_t written = send(conn->fd, conn->out, conn->out_len,
+				MSG_NOSIGNAL);
+		if (written == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				return true;
+			}
+			wlr_log_errno(WLR_ERROR, "Unable to send IPC message");
+			return false;
+		}
+		memmove(conn->out, conn->out + written, conn->out_len - written);
+		conn->out_len -= written;
+	}
+	return true;
+}
+
+bool ipc_connection_send(struct ipc_connection *conn, uint32_t type,
+		const char *payload, uint32_t len, ipc_response_func on_reply,
+		void *data) {
+	if (conn->failed) {
+		return false;
+	}
+	char header[ipc_header_size];
+	fill_header(header, type, len);
+	struct iovec iov[2] = {
+		{ .iov_base = header, .iov_len = ipc_header_size },
+		{ .iov_base = (void *)payload, .iov_len = len },
+	};
+
+	// Earlier requests must go first, so only write directly when none are
+	// still queued
+	if (conn->out_len == 0) {
+		ssize_t written;
+		do {
+			written = write_iov(conn->fd, iov, 2);
+		} while (written == -1 && errno == EINTR);
+		if (written == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+			wlr_log_errno(WLR_ERROR, "Unable to send IPC message");
+			conn->failed = true;
+			return false;
+		}
+	}
+
+	size_t left = iov[0].iov_len + iov[1].iov_len;
+	if (left > 0) {
+		if (!buffer_reserve(&conn->out, &conn->out_size,
+					conn->out_len + left)) {
+			conn->failed = true;
+			return false;
+		}
+		for (int i = 0; i < 2; ++i) {
+			memcpy(conn->out + conn->out_len, iov[i].iov_base, iov[i].iov_len);
+			conn->out_len += iov[i].iov_len;
+		}
+	}
+
+	if (!pending_push(conn, on_reply, data)) {
+		conn->failed = true;
+		return false;
+	}
+	return true;
+}
+
+short ipc_connection_poll_events(struct ipc_connection *conn) {
+	return conn->out_len > 0 ? POLLIN | POLLOUT : POLLIN;
+}
+
+static void dispatch_message(struct ipc_connection *conn,
+		struct ipc_response *response) {
+	if (response->type & (1u << 31)) {
+		if (conn->on_event) {
+			conn->on_event(response, conn->event_data);
+		}
+		return;
+	}
+	if (!conn->pending_count) {
+		wlr_log(WLR_ERROR, "Unexpected IPC reply of type %u", response->type);
+		return;
+	}
+	struct ipc_pending_reply *reply = &conn->pending[conn->pending_head];
+	ipc_response_func callback = reply->callback;
+	void *data = reply->data;
+	conn->pending_head = (conn->pending_head + 1) % conn->pending_size;
+	conn->pending_count--;
+	if (callback) {
+		callback(response, data);
+	}
+}
+
+/**
+ * Dispatches every complete message in the input buffer.
+ */
+static bool dispatch_input(struct ipc_connection *conn) {
+	size_t offset = 0;
+	while (conn->in_len - offset >= ipc_header_size) {
+		char *header = conn->in + offset;
+		if (memcmp(header, ipc_magic, sizeof(ipc_magic)) != 0) {
+			wlr_log(WLR_ERROR, "Invalid IPC header");
+			return false;
+		}
+		struct ipc_response response;
+		uint32_t *header32 = (uint32_t *)(header + sizeof(ipc_magic));
+		memcpy(&response.size, &header32[0], sizeof(header32[0]));
+		memcpy(&response.type, &header32[1], sizeof(header32[1]));
+		if (conn->in_len - offset - ipc_header_size < response.size) {
+			break;
+		}
+		response.payload = malloc(response.size + 1);
+		if (!response.payload) {
+			wlr_log(WLR_ERROR, "Unable to allocate memory for IPC response");
+			return false;
+		}
+		memcpy(response.payload, header + ipc_header_size, response.size);
+		response.payload[response.size] = '\0';
+		offset += ipc_header_size + response.size;
+		dispatch_message(conn, &response);
+		free(response.payload);
+	}
+	memmove(conn->in, conn->in + offset, conn->in_len - offset);
+	conn->in_len -= offset;
+	return true;
+}
+
+bool ipc_connection_dispatch(struct ipc_connection *conn, short revents) {
+	if (conn->failed) {
+		return false;
+	}
+	if ((revents & POLLOUT) && !flush_output(conn)) {
+		conn->failed = true;
+		return false;
+	}
+	if (revents & (POLLIN | POLLHUP | POLLERR)) {
+		while (true) {
+			if (!buffer_reserve(&conn->in, &conn->in_size, conn->in_len + 4096)) {
+				conn->failed = true;
+				return false;
+			}
+			ssize_t received = recv(conn->fd, conn->in + conn->in_len,
+					conn->in_size - conn->in_len, 0);
+			if (received == 0) {
+				// Deliver what arrived before the hangup
+				dispatch_input(conn);
+				conn->failed = true;
+				return false;
+			} else if (received == -1) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					break;
+				}
+				wlr_log_errno(WLR_ERROR, "Unable to receive IPC response");
+				conn->failed = true;
+				return false;
+			}
+			conn->in_len += received;
+		}
+		if (!dispatch_input(conn)) {
+			conn->failed = true;
+			return false;
+		}
+	}
+	return true;
+}
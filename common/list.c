@@ -9,16 +9,35 @@ list_t *create_list(void) {
 	if (!list) {
 		return NULL;
 	}
-	list->capacity = 10;
+	list->capacity = LIST_INLINE_CAPACITY;
 	list->length = 0;
-	list->items = malloc(sizeof(void*) * list->capacity);
+	list->items = list->inline_items;
 	return list;
 }
 
+void list_reserve(list_t *list, int capacity) {
+	if (capacity <= list->capacity) {
+		return;
+	}
+	void **items;
+	if (list->items == list->inline_items) {
+		items = malloc(sizeof(void*) * capacity);
+		if (items) {
+			memcpy(items, list->inline_items, sizeof(void*) * list->length);
+		}
+	} else {
+		items = realloc(list->items, sizeof(void*) * capacity);
+	}
+	if (!sway_assert(items, "Unable to grow list")) {
+		return;
+	}
+	list->items = items;
+	list->capacity = capacity;
+}
+
 static void list_resize(list_t *list) {
 	if (list->length == list->capacity) {
-		list->capacity += 10;
-		list->items = realloc(list->items, sizeof(void*) * list->capacity);
+		list_reserve(list, list->capacity * 2);
 	}
 }
 
@@ -26,7 +45,9 @@ void list_free(list_t *list) {
 	if (list == NULL) {
 		return;
 	}
-	free(list->items);
+	if (list->items != list->inline_items) {
+		free(list->items);
+	}
 	free(list);
 }
 
@@ -56,7 +77,12 @@ void list_del(list_t *list, int index) {
 	memmove(&list->items[index], &list->items[index + 1], sizeof(void*) * (list->length - index));
 }
 
+void list_del_unordered(list_t *list, int index) {
+	list->items[index] = list->items[--list->length];
+}
+
 void list_cat(list_t *list, list_t *source) {
+	list_reserve(list, list->length + source->length);
 	int i;
 	for (i = 0; i < source->length; ++i) {
 		list_add(list, source->items[i]);
@@ -0,0 +1,277 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "list.h"
+#include "log.h"
+#include "loop.h"
+
+#define LOOP_MAX_EVENTS 16
+
+struct loop_fd_event {
+	int fd; // -1 once removed
+	void (*callback)(int fd, short mask, void *data);
+	void *data;
+	struct loop_timer *timer; // Owned by the event if set
+};
+
+struct loop_timer {
+	int fd; // -1 once fired or removed
+	void (*callback)(void *data);
+	void *data;
+	struct loop *loop;
+};
+
+struct loop {
+	int epoll_fd;
+
+	// Indexed by file descriptor, for constant time removal
+	struct loop_fd_event **fd_events;
+	int fd_events_capacity;
+
+	/*
+	 * Removed events are freed after the current batch has been dispatched,
+	 * as epoll may have already returned them.
+	 */
+	list_t *removed; // struct loop_fd_event
+};
+
+struct loop *loop_create(void) {
+	struct loop *loop = calloc(1, sizeof(struct loop));
+	if (!loop) {
+		wlr_log(WLR_ERROR, "Unable to allocate memory for event loop");
+		return NULL;
+	}
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll_fd == -1) {
+		wlr_log_errno(WLR_ERROR, "Unable to create epoll instance");
+		free(loop);
+		return NULL;
+	}
+	loop->removed = create_list();
+	return loop;
+}
+
+static void free_removed(struct loop *loop) {
+	for (int i = 0; i < loop->removed->length; ++i) {
+		struct loop_fd_event *event = loop->removed->items[i];
+		free(event->timer);
+		free(event);
+	}
+	loop->removed->length = 0;
+}
+
+void loop_destroy(struct loop *loop) {
+	for (int fd = 0; fd < loop->fd_events_capacity; ++fd) {
+		struct loop_fd_event *event = loop->fd_events[fd];
+		if (!event) {
+			continue;
+		}
+		if (event->timer) {
+			close(fd);
+			free(event->timer);
+		}
+		free(event);
+	}
+	free_removed(loop);
+	list_free(loop->removed);
+	free(loop->fd_events);
+	close(loop->epoll_fd);
+	free(loop);
+}
+
+static uint32_t poll_to_epoll(short mask) {
+	uint32_t events = 0;
+	if (mask & POLLIN) {
+		events |= EPOLLIN;
+	}
+	if (mask & POLLOUT) {
+		events |= EPOLLOUT;
+	}
+	if (mask & POLLPRI) {
+		events |= EPOLLPRI;
+	}
+	return events;
+}
+
+static short epoll_to_poll(uint32_t events) {
+	short mask = 0;
+	if (events & EPOLLIN) {
+		mask |= POLLIN;
+	}
+	if (events & EPOLLOUT) {
+		mask |= POLLOUT;
+	}
+	if (events & EPOLLPRI) {
+		mask |= POLLPRI;
+	}
+	if (events & EPOLLHUP) {
+		mask |= POLLHUP;
+	}
+	if (events & EPOLLERR) {
+		mask |= POLLERR;
+	}
+	return mask;
+}
+
+void loop_poll(struct loop *loop) {
+	struct epoll_event events[LOOP_MAX_EVENTS];
+	int count = epoll_wait(loop->epoll_fd, events, LOOP_MAX_EVENTS, -1);
+	if (count == -1) {
+		if (errno != EINTR) {
+			wlr_log_errno(WLR_ERROR, "epoll_wait failed");
+		}
+		return;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		struct loop_fd_event *event = events[i].data.ptr;
+		if (event->fd == -1) {
+			continue; // Removed by an earlier callback
+		}
+		event->callback(event->fd, epoll_to_poll(events[i].events),
+				event->data);
+	}
+
+	free_removed(loop);
+}
+
+static bool reserve_fd(struct loop *loop, int fd) {
+	if (fd < loop->fd_events_capacity) {
+		return true;
+	}
+	int capacity = loop->fd_events_capacity ? loop->fd_events_capacity : 16;
+	while (capacity <= fd) {
+		capacity *= 2;
+	}
+	struct loop_fd_event **fd_events = realloc(loop->fd_events,
+			sizeof(struct loop_fd_event *) * capacity);
+	if (!fd_events) {
+		return false;
+	}
+	memset(&fd_events[loop->fd_events_capacity], 0,
+			sizeof(struct loop_fd_event *) *
+			(capacity - loop->fd_events_capacity));
+	loop->fd_events = fd_events;
+	loop->fd_events_capacity = capacity;
+	return true;
+}
+
+static struct loop_fd_event *add_fd(struct loop *loop, int fd, short mask,
+		void (*callback)(int fd, short mask, void *data), void *data) {
+	if (fd < 0 || !reserve_fd(loop, fd)) {
+		wlr_log(WLR_ERROR, "Unable to add fd %d to event loop", fd);
+		return NULL;
+	}
+	if (loop->fd_events[fd]) {
+		wlr_log(WLR_ERROR, "fd %d is already in the event loop", fd);
+		return NULL;
+	}
+
+	struct loop_fd_event *event = calloc(1, sizeof(struct loop_fd_event));
+	if (!event) {
+		wlr_log(WLR_ERROR, "Unable to allocate memory for event");
+		return NULL;
+	}
+	event->fd = fd;
+	event->callback = callback;
+	event->data = data;
+
+	struct epoll_event ev = {
+		.events = poll_to_epoll(mask),
+		.data.ptr = event,
+	};
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		wlr_log_errno(WLR_ERROR, "Unable to add fd %d to epoll", fd);
+		free(event);
+		return NULL;
+	}
+	loop->fd_events[fd] = event;
+	return event;
+}
+
+bool loop_add_fd(struct loop *loop, int fd, short mask,
+		void (*callback)(int fd, short mask, void *data), void *data) {
+	return add_fd(loop, fd, mask, callback, data) != NULL;
+}
+
+static void handle_timer(int fd, short mask, void *data) {
+	struct loop_timer *timer = data;
+	uint64_t expirations;
+	read(fd, &expirations, sizeof(expirations));
+	timer->callback(timer->data);
+	// The callback may have removed the timer already
+	loop_remove_timer(timer->loop, timer);
+}
+
+struct loop_timer *loop_add_timer(struct loop *loop, int ms,
+		void (*callback)(void *data), void *data) {
+	struct loop_timer *timer = calloc(1, sizeof(struct loop_timer));
+	if (!timer) {
+		wlr_log(WLR_ERROR, "Unable to allocate memory for timer");
+		return NULL;
+	}
+	timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (timer->fd == -1) {
+		wlr_log_errno(WLR_ERROR, "Unable to create timer");
+		free(timer);
+		return NULL;
+	}
+	timer->callback = callback;
+	timer->data = data;
+	timer->loop = loop;
+
+	// A zero it_value would disarm the timer, so fire after 1ns instead
+	struct itimerspec spec = {
+		.it_value = {
+			.tv_sec = ms / 1000,
+			.tv_nsec = ms > 0 ? (ms % 1000) * 1000000 : 1,
+		},
+	};
+	if (timerfd_settime(timer->fd, 0, &spec, NULL) == -1) {
+		wlr_log_errno(WLR_ERROR, "Unable to arm timer");
+		close(timer->fd);
+		free(timer);
+		return NULL;
+	}
+
+	struct loop_fd_event *event =
+		add_fd(loop, timer->fd, POLLIN, handle_timer, timer);
+	if (!event) {
+		close(timer->fd);
+		free(timer);
+		return NULL;
+	}
+	event->timer = timer;
+	return timer;
+}
+
+bool loop_remove_fd(struct loop *loop, int fd) {
+	if (fd < 0 || fd >= loop->fd_events_capacity || !loop->fd_events[fd]) {
+		return false;
+	}
+	struct loop_fd_event *event = loop->fd_events[fd];
+	loop->fd_events[fd] = NULL;
+	epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	event->fd = -1;
+	list_add(loop->removed, event);
+	return true;
+}
+
+bool loop_remove_timer(struct loop *loop, struct loop_timer *timer) {
+	if (timer->fd == -1) {
+		return false;
+	}
+	int fd = timer->fd;
+	timer->fd = -1;
+	// The timer is freed along with its event
+	loop_remove_fd(loop, fd);
+	close(fd);
+	return true;
+}
@@ -0,0 +1,42 @@
+#ifndef _SWAY_BENCH_H
+#define _SWAY_BENCH_H
+#include <json-c/json.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A growing set of timing samples, summarized once a run is over.
+ */
+struct bench_samples {
+	double *values;
+	size_t length, capacity;
+};
+
+/**
+ * Monotonic time in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+void bench_samples_add(struct bench_samples *samples, double value);
+
+/**
+ * Returns an object with the count, min, mean, median, p99 and max of the
+ * samples. The samples are sorted in the process.
+ */
+json_object *bench_samples_summary(struct bench_samples *samples);
+
+void bench_samples_finish(struct bench_samples *samples);
+
+/**
+ * Number of allocations made so far. Only counted in programs linked with
+ * bench/alloc.c and the matching --wrap linker flags.
+ */
+extern size_t bench_allocations;
+
+/**
+ * Runs the function repeatedly for a fixed time budget and prints its name
+ * with the ns/op and allocations/op.
+ */
+void bench_run(const char *name, void (*run)(void *data), void *data);
+
+#endif
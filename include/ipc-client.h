@@ -1,6 +1,7 @@
 #ifndef _SWAY_IPC_CLIENT_H
 #define _SWAY_IPC_CLIENT_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "ipc.h"
@@ -37,4 +38,52 @@ struct ipc_response *ipc_recv_response(int socketfd);
  */
 void free_ipc_response(struct ipc_response *response);
 
+/**
+ * A non-blocking connection to sway, for clients with their own poll loop.
+ * Any number of requests can be in flight at once; replies are matched to
+ * requests in order, and events arriving in between go to the event callback.
+ *
+ * The response passed to a callback is freed when the callback returns.
+ * Callbacks may send further requests but must not destroy the connection.
+ */
+struct ipc_connection;
+
+typedef void (*ipc_response_func)(struct ipc_response *response, void *data);
+
+/**
+ * Takes ownership of socketfd and makes it non-blocking. on_event may be NULL.
+ */
+struct ipc_connection *ipc_connection_create(int socketfd,
+		ipc_response_func on_event, void *data);
+
+void ipc_connection_destroy(struct ipc_connection *conn);
+
+int ipc_connection_get_fd(struct ipc_connection *conn);
+
+/**
+ * Queues a request and sends as much of it as the socket takes. on_reply may be
+ * NULL to discard the reply. Returns false if the connection has failed.
+ */
+bool ipc_connection_send(struct ipc_connection *conn, uint32_t type,
+		const char *payload, uint32_t len, ipc_response_func on_reply,
+		void *data);
+
+/**
+ * The poll(2) events to wait for: POLLIN, plus POLLOUT while requests are
+ * waiting to be written.
+ */
+short ipc_connection_poll_events(struct ipc_connection *conn);
+
+/**
+ * Handles the revents poll(2) reported for the connection's fd, sending any
+ * queued requests and dispatching every complete reply and event. Returns false
+ * once the connection has been closed or has failed.
+ */
+bool ipc_connection_dispatch(struct ipc_connection *conn, short revents);
+
+/**
+ * The number of requests still waiting for a reply.
+ */
+int ipc_connection_pending(struct ipc_connection *conn);
+
 #endif
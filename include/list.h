@@ -1,18 +1,28 @@
 #ifndef _SWAY_LIST_H
 #define _SWAY_LIST_H
 
+// Most lists (children, marks, per-container outputs) hold a handful of items,
+// so the first few live in the list itself and need no separate allocation.
+#define LIST_INLINE_CAPACITY 4
+
 typedef struct {
 	int capacity;
 	int length;
-	void **items;
+	void **items; // inline_items until the list outgrows it
+	void *inline_items[LIST_INLINE_CAPACITY];
 } list_t;
 
 list_t *create_list(void);
 void list_free(list_t *list);
 void list_foreach(list_t *list, void (*callback)(void* item));
+// Grow the list so it can hold at least capacity items without reallocating
+void list_reserve(list_t *list, int capacity);
 void list_add(list_t *list, void *item);
 void list_insert(list_t *list, int index, void *item);
 void list_del(list_t *list, int index);
+// Remove the item at index by moving the last item into its place. O(1), but
+// does not preserve order.
+void list_del_unordered(list_t *list, int index);
 void list_cat(list_t *list, list_t *source);
 // See qsort. Remember to use *_qsort functions as compare functions,
 // because they dereference the left and right arguments first!
@@ -0,0 +1,38 @@
+#ifndef _SWAY_LOOP_H
+#define _SWAY_LOOP_H
+#include <stdbool.h>
+
+/**
+ * This is an epoll based event loop for the client programs (swaybar and
+ * swaynag). File descriptors and timers can be added and removed in constant
+ * time, including from within a callback.
+ */
+struct loop;
+struct loop_timer;
+
+struct loop *loop_create(void);
+
+void loop_destroy(struct loop *loop);
+
+// Blocks until at least one event arrives and returns after sending callbacks
+void loop_poll(struct loop *loop);
+
+// mask takes poll(2) flags; POLLHUP and POLLERR are always reported
+bool loop_add_fd(struct loop *loop, int fd, short mask,
+		void (*callback)(int fd, short mask, void *data), void *data);
+
+// Calls callback once after ms milliseconds. The loop frees the timer as soon
+// as the callback returns, so anyone keeping the returned pointer must clear it
+// from within the callback.
+struct loop_timer *loop_add_timer(struct loop *loop, int ms,
+		void (*callback)(void *data), void *data);
+
+// Returns false if nothing exists, true otherwise
+bool loop_remove_fd(struct loop *loop, int fd);
+
+// Cancels a timer that hasn't fired yet, or the timer whose callback is running.
+// Returns false if the timer was already removed. Once the callback has
+// returned the timer is freed, and passing it here is a use after free.
+bool loop_remove_timer(struct loop *loop, struct loop_timer *timer);
+
+#endif
@@ -6,6 +6,11 @@
 #include <stdint.h>
 #include <wayland-client.h>
 
+// Two buffers are used normally, the third only while both are busy
+#define POOL_BUFFER_COUNT 3
+
+struct shm_pool;
+
 struct pool_buffer {
 	struct wl_buffer *buffer;
 	cairo_surface_t *surface;
@@ -13,12 +18,17 @@ struct pool_buffer {
 	PangoContext *pango;
 	uint32_t width, height;
 	void *data;
-	size_t size;
 	bool busy;
+
+	// The buffer's space in the shared pool, kept across resizes if it fits
+	struct shm_pool *pool;
+	size_t offset, size;
+	struct wl_list link; // shm_pool::buffers
 };
 
 struct pool_buffer *get_next_buffer(struct wl_shm *shm,
-		struct pool_buffer pool[static 2], uint32_t width, uint32_t height);
+		struct pool_buffer pool[static POOL_BUFFER_COUNT],
+		uint32_t width, uint32_t height);
 void destroy_buffer(struct pool_buffer *buffer);
 
 #endif
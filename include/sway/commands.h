@@ -110,6 +110,7 @@ sway_cmd cmd_client_unfocused;
 sway_cmd cmd_client_urgent;
 sway_cmd cmd_client_placeholder;
 sway_cmd cmd_client_background;
+sway_cmd cmd_coalesce_pointer_motion;
 sway_cmd cmd_commands;
 sway_cmd cmd_create_output;
 sway_cmd cmd_debuglog;
@@ -175,6 +176,7 @@ sway_cmd cmd_swaynag_command;
 sway_cmd cmd_swap;
 sway_cmd cmd_tiling_drag;
 sway_cmd cmd_title_format;
+sway_cmd cmd_trace;
 sway_cmd cmd_unmark;
 sway_cmd cmd_urgent;
 sway_cmd cmd_workspace;
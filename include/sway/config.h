@@ -213,7 +213,7 @@ struct bar_config {
 	bool strip_workspace_numbers;
 	bool binding_mode_indicator;
 	bool verbose;
-	pid_t pid;
+	pid_t pid; // Only set on the first bar sharing a swaybar process
 	struct {
 		char *background;
 		char *statusline;
@@ -377,6 +377,7 @@ struct sway_config {
 
 	// Flags
 	bool focus_follows_mouse;
+	bool coalesce_pointer_motion;
 	bool raise_floating;
 	enum mouse_warping_mode mouse_warping;
 	enum focus_wrapping_mode focus_wrapping;
@@ -535,6 +536,12 @@ void load_swaybars(void);
 
 void terminate_swaybg(pid_t pid);
 
+// Restarts swaybg with the current backgrounds once the event loop is idle
+void update_swaybg(void);
+
+// Stops the custom swaybg_command serving this output, if any
+void output_terminate_swaybg(struct sway_output *output);
+
 struct bar_config *default_bar_config(void);
 
 void free_bar_config(struct bar_config *bar);
@@ -1,12 +1,16 @@
 #ifndef SWAY_DEBUG_H
 #define SWAY_DEBUG_H
 #include <stdbool.h>
+#include <stddef.h>
 
 struct sway_debug {
 	bool noatomic;         // Ignore atomic layout updates
 	bool render_tree;      // Render the tree overlay
 	bool txn_timings;      // Log verbose messages about transactions
 	bool txn_wait;         // Always wait for the timeout before applying
+	bool trace;            // Record spans into the trace ring buffer
+	char *trace_path;      // Where to write the trace on exit, if anywhere
+	int dispatch_threshold_ms; // Log event loop dispatches slower than this
 
 	enum {
 		DAMAGE_DEFAULT,    // Default behaviour
@@ -17,6 +21,15 @@ struct sway_debug {
 
 extern struct sway_debug debug;
 
+// Counters shown in the render-tree overlay
+struct sway_debug_stats {
+	size_t txn_allocs;     // Transaction objects taken from the allocator
+	size_t txn_reuses;     // Transaction objects taken from the pools
+	size_t arrange_skips;  // Arranged nodes left clean because nothing changed
+};
+
+extern struct sway_debug_stats debug_stats;
+
 void update_debug_tree(void);
 
 #endif
@@ -0,0 +1,41 @@
+#ifndef _SWAY_DISPATCH_H
+#define _SWAY_DISPATCH_H
+#include <stdint.h>
+#include <wayland-util.h>
+
+/**
+ * Time spent handling one kind of event loop source, or one IPC client.
+ *
+ * Handlers call dispatch_begin on entry and dispatch_end on exit. Any single
+ * dispatch longer than -D dispatch-threshold=<ms> is logged, which points at
+ * what stalled a frame.
+ */
+struct dispatch_stats {
+	const char *name;
+	uint64_t count;
+	uint64_t total_ns, max_ns;
+	struct wl_list link; // all stats, added on first use
+};
+
+uint64_t dispatch_begin(void);
+
+void dispatch_end(struct dispatch_stats *stats, uint64_t start);
+
+/**
+ * Logs the stats' totals and stops tracking them, for stats that are about to
+ * be freed.
+ */
+void dispatch_stats_finish(struct dispatch_stats *stats);
+
+/**
+ * Logs the totals of every source seen so far.
+ */
+void dispatch_log_stats(void);
+
+/**
+ * Calls the iterator with each source seen so far, for display.
+ */
+void dispatch_for_each_stats(void (*f)(struct dispatch_stats *stats,
+			void *data), void *data);
+
+#endif
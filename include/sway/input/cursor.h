@@ -33,6 +33,16 @@ struct sway_cursor {
 
 	struct wl_listener request_set_cursor;
 
+	// Interactive resizes are applied at most once per output frame
+	struct wl_event_source *resize_timer;
+	bool resize_pending;
+	uint32_t resize_last_msec;
+
+	// Pointer motion queued by coalesce_pointer_motion
+	struct wl_event_source *motion_timer;
+	bool motion_pending;
+	uint32_t motion_time_msec;
+
 	// Mouse binding state
 	uint32_t pressed_buttons[SWAY_CURSOR_PRESSED_BUTTONS_CAP];
 	size_t pressed_button_count;
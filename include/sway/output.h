@@ -36,6 +36,10 @@ struct sway_output {
 
 	struct sway_output_state current;
 
+	// Views which are visible on this output, in the order they are stacked.
+	// Rebuilt whenever a transaction is applied.
+	list_t *visible_views; // struct sway_view *
+
 	struct wl_listener destroy;
 	struct wl_listener mode;
 	struct wl_listener transform;
@@ -45,7 +49,13 @@ struct sway_output {
 
 	struct wl_list link;
 
+	// Arguments for swaybg ("<path> <mode> [fallback]"), or NULL if there is
+	// no background
+	char *bg_args;
+	bool bg_fallback; // Whether bg_args ends with a fallback color
+	// The custom swaybg_command serving this output alone, if one is running
 	pid_t bg_pid;
+	char *bg_command;
 
 	struct {
 		struct wl_signal destroy;
@@ -97,6 +107,8 @@ bool output_has_opaque_overlay_layer_surface(struct sway_output *output);
 
 struct sway_workspace *output_get_active_workspace(struct sway_output *output);
 
+void output_update_visible_views(struct sway_output *output);
+
 void output_render(struct sway_output *output, struct timespec *when,
 	pixman_region32_t *damage);
 
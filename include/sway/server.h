@@ -59,7 +59,9 @@ struct sway_server {
 	struct wl_list xdg_decorations; // sway_xdg_decoration::link
 
 	size_t txn_timeout_ms;
-	list_t *transactions;
+	// The transaction waiting on views, and at most one queued behind it
+	struct sway_transaction *committed_transaction;
+	struct sway_transaction *queued_transaction;
 	list_t *dirty_nodes;
 };
 
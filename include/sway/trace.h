@@ -0,0 +1,45 @@
+#ifndef _SWAY_TRACE_H
+#define _SWAY_TRACE_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Spans of compositor activity, recorded into a fixed-size ring buffer and
+ * written out as Chrome trace-event JSON (which Perfetto also loads).
+ *
+ * Usage:
+ *
+ *	uint64_t start = trace_begin();
+ *	...
+ *	trace_end(start, "name", detail);
+ *
+ * When tracing is disabled trace_begin returns 0 and trace_end returns
+ * immediately, so instrumented paths cost a branch.
+ */
+
+void trace_enable(void);
+
+void trace_disable(void);
+
+bool trace_is_enabled(void);
+
+uint64_t trace_begin(void);
+
+/**
+ * Records a span from start until now. The name must be a string literal;
+ * the detail is copied (and truncated) and may be NULL.
+ */
+void trace_end(uint64_t start, const char *name, const char *detail);
+
+/**
+ * Writes the events in the ring buffer to a file, oldest first.
+ */
+bool trace_write(const char *path);
+
+/**
+ * Writes the trace to the path given with -D trace=<path>, if any, and
+ * frees the ring buffer.
+ */
+void trace_finish(void);
+
+#endif
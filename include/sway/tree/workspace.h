@@ -41,6 +41,7 @@ struct sway_workspace {
 	list_t *tiling;             // struct sway_container
 	list_t *output_priority;
 	bool urgent;
+	bool layout_stale;          // Arranging was deferred while hidden
 
 	struct sway_workspace_state current;
 };
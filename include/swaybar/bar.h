@@ -1,6 +1,7 @@
 #ifndef _SWAYBAR_BAR_H
 #define _SWAYBAR_BAR_H
 #include <wayland-client.h>
+#include "loop.h"
 #include "pool-buffer.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 #include "xdg-output-unstable-v1-client-protocol.h"
@@ -57,12 +58,22 @@ struct swaybar {
 	struct swaybar_pointer pointer;
 	struct status_line *status;
 
+	struct loop *eventloop;
+
 	int ipc_event_socketfd;
 	int ipc_socketfd;
 
 	struct wl_list outputs;
 };
 
+// What was last committed to an output's surface, used to work out damage
+struct swaybar_output_frame {
+	uint32_t width, height;
+	int32_t scale;
+	uint32_t background;
+	struct wl_array items; // struct render_item
+};
+
 struct swaybar_output {
 	struct wl_list link;
 	struct swaybar *bar;
@@ -81,14 +92,17 @@ struct swaybar_output {
 	uint32_t width, height;
 	int32_t scale;
 	enum wl_output_subpixel subpixel;
-	struct pool_buffer buffers[2];
+	struct pool_buffer buffers[POOL_BUFFER_COUNT];
 	struct pool_buffer *current_buffer;
+	struct wl_list render_cache; // render_cache_entry::link
+	struct swaybar_output_frame last_frame;
 	bool dirty;
 	bool frame_scheduled;
 };
 
 struct swaybar_workspace {
 	struct wl_list link;
+	int id;
 	int num;
 	char *name;
 	bool focused;
@@ -96,10 +110,17 @@ struct swaybar_workspace {
 	bool urgent;
 };
 
-bool bar_setup(struct swaybar *bar, const char *socket_path, const char *bar_id);
+bool bar_setup(struct swaybar *bar, struct loop *eventloop,
+		const char *socket_path, const char *bar_id);
+// Adds the bar's event sources to its event loop
 void bar_run(struct swaybar *bar);
 void bar_teardown(struct swaybar *bar);
 
+void set_bar_dirty(struct swaybar *bar);
+
+void set_output_dirty(struct swaybar_output *output);
+
+void free_workspace(struct swaybar_workspace *ws);
 void free_workspaces(struct wl_list *list);
 
 #endif
@@ -22,6 +22,7 @@ struct i3bar_block {
 	int border_bottom;
 	int border_left;
 	int border_right;
+	uint32_t hash; // of all of the above, used to diff updates
 };
 
 void i3bar_block_unref(struct i3bar_block *block);
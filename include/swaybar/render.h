@@ -4,5 +4,6 @@
 struct swaybar_output;
 
 void render_frame(struct swaybar_output *output);
+void render_free_cache(struct swaybar_output *output);
 
 #endif
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "bar.h"
+#include "list.h"
 
 enum status_protocol {
 	PROTOCOL_UNDEF,
@@ -13,7 +14,14 @@ enum status_protocol {
 	PROTOCOL_I3BAR,
 };
 
+/**
+ * Bars in the same swaybar process with the same status_command share one
+ * status_line, and so one instance of the command.
+ */
 struct status_line {
+	char *command;
+	list_t *bars; // struct swaybar, the bars showing this status line
+	struct loop *eventloop;
 	pid_t pid;
 	int read_fd, write_fd;
 	FILE *read, *write;
@@ -32,9 +40,14 @@ struct status_line {
 	json_tokener *tokener;
 };
 
-struct status_line *status_line_init(char *cmd);
+/**
+ * Returns the status line running cmd, starting the command if no other bar
+ * is already running it.
+ */
+struct status_line *status_line_init(struct swaybar *bar, char *cmd);
 void status_error(struct status_line *status, const char *text);
 bool status_handle_readable(struct status_line *status);
-void status_line_free(struct status_line *status);
+// Stops the command once no bars are left using it
+void status_line_release(struct status_line *status, struct swaybar *bar);
 
 #endif
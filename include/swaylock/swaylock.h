@@ -2,9 +2,11 @@
 #define _SWAYLOCK_H
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/types.h>
 #include <wayland-client.h>
 #include "background-image.h"
 #include "cairo.h"
+#include "loop.h"
 #include "pool-buffer.h"
 #include "swaylock/seat.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
@@ -56,6 +58,7 @@ struct swaylock_password {
 struct swaylock_state {
 	struct wl_display *display;
 	struct wl_compositor *compositor;
+	struct wl_subcompositor *subcompositor;
 	struct zwlr_layer_shell_v1 *layer_shell;
 	struct zwlr_input_inhibit_manager_v1 *input_inhibit_manager;
 	struct wl_pointer *pointer;
@@ -68,6 +71,8 @@ struct swaylock_state {
 	struct swaylock_xkb xkb;
 	enum auth_state auth_state;
 	bool run_display;
+	struct loop *eventloop;
+	struct loop_timer *verify_timer;
 	struct zxdg_output_manager_v1 *zxdg_output_manager;
 };
 
@@ -77,13 +82,19 @@ struct swaylock_surface {
 	struct wl_output *output;
 	uint32_t output_global_name;
 	struct zxdg_output_v1 *xdg_output;
-	struct wl_surface *surface;
+	struct wl_surface *surface; // background
+	struct wl_surface *child; // indicator
+	struct wl_subsurface *subsurface;
 	struct zwlr_layer_surface_v1 *layer_surface;
-	struct pool_buffer buffers[2];
+	struct pool_buffer buffers[POOL_BUFFER_COUNT];
+	struct pool_buffer indicator_buffers[POOL_BUFFER_COUNT];
 	struct pool_buffer *current_buffer;
 	bool frame_pending, dirty;
 	uint32_t width, height;
 	int32_t scale;
+	// Size and scale the background was last drawn at
+	uint32_t background_width, background_height;
+	int32_t background_scale;
 	enum wl_output_subpixel subpixel;
 	char *output_name;
 	struct wl_list link;
@@ -103,8 +114,22 @@ void render_frame(struct swaylock_surface *surface);
 void render_frames(struct swaylock_state *state);
 void damage_surface(struct swaylock_surface *surface);
 void damage_state(struct swaylock_state *state);
-void initialize_pw_backend(void);
-bool attempt_password(struct swaylock_password *pw);
 void clear_password_buffer(struct swaylock_password *pw);
+void clear_buffer(void *buf, size_t bytes);
+
+void initialize_pw_backend(void);
+void run_pw_backend_child(void);
+
+bool spawn_comm_child(void);
+// Reaps a password checking child which went away and starts a new one
+bool respawn_comm_child(void);
+ssize_t read_comm_request(char **buf_ptr);
+bool write_comm_reply(bool success);
+// Requests a password check, and clears the password buffer
+bool write_comm_request(struct swaylock_password *pw);
+// Returns 1 if the password was correct, 0 if not, -1 if the child is gone
+int read_comm_reply(void);
+// FD to poll for password authentication replies
+int get_comm_reply_fd(void);
 
 #endif
@@ -82,7 +82,7 @@ struct swaynag {
 	uint32_t width;
 	uint32_t height;
 	int32_t scale;
-	struct pool_buffer buffers[2];
+	struct pool_buffer buffers[POOL_BUFFER_COUNT];
 	struct pool_buffer *current_buffer;
 
 	struct swaynag_type *type;
@@ -10,6 +10,7 @@
 #include "sway/config.h"
 #include "sway/criteria.h"
 #include "sway/security.h"
+#include "sway/trace.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/tree/view.h"
@@ -83,6 +84,7 @@ static struct cmd_handler handlers[] = {
 	{ "client.placeholder", cmd_client_noop },
 	{ "client.unfocused", cmd_client_unfocused },
 	{ "client.urgent", cmd_client_urgent },
+	{ "coalesce_pointer_motion", cmd_coalesce_pointer_motion },
 	{ "default_border", cmd_default_border },
 	{ "default_floating_border", cmd_default_floating_border },
 	{ "exec", cmd_exec },
@@ -153,6 +155,7 @@ static struct cmd_handler command_handlers[] = {
 	{ "sticky", cmd_sticky },
 	{ "swap", cmd_swap },
 	{ "title_format", cmd_title_format },
+	{ "trace", cmd_trace },
 	{ "unmark", cmd_unmark },
 	{ "urgent", cmd_urgent },
 };
@@ -246,6 +249,8 @@ struct cmd_results *execute_command(char *_exec, struct sway_seat *seat,
 		}
 	}
 
+	uint64_t trace_start = trace_begin();
+
 	// This is the container or workspace which this command will run on.
 	// Ignored if the command string contains criteria.
 	struct sway_node *node;
@@ -353,6 +358,7 @@ cleanup:
 	if (!results) {
 		results = cmd_results_new(CMD_SUCCESS, NULL, NULL);
 	}
+	trace_end(trace_start, "execute_command", _exec);
 	return results;
 }
 
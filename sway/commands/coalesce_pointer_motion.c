@@ -0,0 +1,13 @@
+#include "sway/commands.h"
+#include "util.h"
+
+struct cmd_results *cmd_coalesce_pointer_motion(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "coalesce_pointer_motion",
+					EXPECTED_EQUAL_TO, 1))) {
+		return error;
+	}
+	config->coalesce_pointer_motion =
+		parse_boolean(argv[0], config->coalesce_pointer_motion);
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
@@ -0,0 +1,32 @@
+#include <string.h>
+#include "sway/commands.h"
+#include "sway/trace.h"
+#include "util.h"
+
+struct cmd_results *cmd_trace(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "trace", EXPECTED_AT_LEAST, 1))) {
+		return error;
+	}
+
+	if (strcmp(argv[0], "dump") == 0) {
+		if ((error = checkarg(argc, "trace", EXPECTED_EQUAL_TO, 2))) {
+			return error;
+		}
+		if (!trace_write(argv[1])) {
+			return cmd_results_new(CMD_FAILURE, "trace",
+					"Unable to write trace to %s", argv[1]);
+		}
+		return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+	}
+
+	if ((error = checkarg(argc, "trace", EXPECTED_EQUAL_TO, 1))) {
+		return error;
+	}
+	if (parse_boolean(argv[0], trace_is_enabled())) {
+		trace_enable();
+	} else {
+		trace_disable();
+	}
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
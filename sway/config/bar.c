@@ -9,6 +9,7 @@
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <string.h>
 #include <strings.h>
 #include <signal.h>
 #include "sway/config.h"
@@ -172,7 +173,11 @@ cleanup:
 	return NULL;
 }
 
-static void invoke_swaybar(struct bar_config *bar) {
+/**
+ * Starts a swaybar serving each bar in bar_ids, with the first bar's
+ * swaybar_command. The process id is stored on that bar.
+ */
+static void invoke_swaybar(struct bar_config *bar, list_t *bar_ids) {
 	// Pipe to communicate errors
 	int filedes[2];
 	if (pipe(filedes) == -1) {
@@ -189,9 +194,12 @@ static void invoke_swaybar(struct bar_config *bar) {
 		sigprocmask(SIG_SETMASK, &set, NULL);
 
 		// run custom swaybar
-		size_t len = snprintf(NULL, 0, "%s -b %s",
-				bar->swaybar_command ? bar->swaybar_command : "swaybar",
-				bar->id);
+		const char *swaybar =
+			bar->swaybar_command ? bar->swaybar_command : "swaybar";
+		size_t len = strlen(swaybar);
+		for (int i = 0; i < bar_ids->length; ++i) {
+			len += strlen(" -b ") + strlen(bar_ids->items[i]);
+		}
 		char *command = malloc(len + 1);
 		if (!command) {
 			const char msg[] = "Unable to allocate swaybar command string";
@@ -201,9 +209,10 @@ static void invoke_swaybar(struct bar_config *bar) {
 			close(filedes[1]);
 			exit(1);
 		}
-		snprintf(command, len + 1, "%s -b %s",
-				bar->swaybar_command ? bar->swaybar_command : "swaybar",
-				bar->id);
+		char *pos = command + sprintf(command, "%s", swaybar);
+		for (int i = 0; i < bar_ids->length; ++i) {
+			pos += sprintf(pos, " -b %s", (char *)bar_ids->items[i]);
+		}
 		char *const cmd[] = { "sh", "-c", command, NULL, };
 		close(filedes[1]);
 		execvp(cmd[0], cmd);
@@ -231,8 +240,35 @@ void load_swaybars(void) {
 		struct bar_config *bar = config->bars->items[i];
 		if (bar->pid != 0) {
 			terminate_swaybar(bar->pid);
+			bar->pid = 0;
+		}
+	}
+
+	/*
+	 * Bars using the default swaybar all run in one process, so bars with
+	 * the same status_command share a single instance of it. Custom
+	 * swaybar_commands may not support that and get a process each.
+	 */
+	struct bar_config *shared = NULL;
+	list_t *shared_ids = create_list();
+	list_t *bar_ids = create_list();
+	for (int i = 0; i < config->bars->length; ++i) {
+		struct bar_config *bar = config->bars->items[i];
+		if (!bar->swaybar_command) {
+			shared = shared ? shared : bar;
+			list_add(shared_ids, bar->id);
+			continue;
 		}
 		wlr_log(WLR_DEBUG, "Invoking swaybar for bar id '%s'", bar->id);
-		invoke_swaybar(bar);
+		list_add(bar_ids, bar->id);
+		invoke_swaybar(bar, bar_ids);
+		bar_ids->length = 0;
+	}
+	if (shared) {
+		wlr_log(WLR_DEBUG, "Invoking swaybar for %d bar(s)",
+				shared_ids->length);
+		invoke_swaybar(shared, shared_ids);
 	}
+	list_free(bar_ids);
+	list_free(shared_ids);
 }
@@ -1,6 +1,7 @@
 #define _XOPEN_SOURCE 700
 #include <assert.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <signal.h>
 #include <sys/wait.h>
@@ -9,6 +10,7 @@
 #include <wlr/types/wlr_output_layout.h>
 #include "sway/config.h"
 #include "sway/output.h"
+#include "sway/server.h"
 #include "sway/tree/root.h"
 #include "log.h"
 
@@ -174,15 +176,139 @@ void terminate_swaybg(pid_t pid) {
 	}
 }
 
+/*
+ * The default swaybg serves every output from one process, restarted whenever
+ * its command line changes. A custom swaybg_command may be a wrapper expecting
+ * a single output, so it gets a process per output in the old
+ * "<index> <path> <mode> [fallback]" form instead.
+ */
+static pid_t swaybg_pid = 0;
+static char *swaybg_running_command = NULL;
+static struct wl_event_source *swaybg_idle = NULL;
+
+static bool swaybg_is_custom(void) {
+	return config->swaybg_command &&
+		strcmp(config->swaybg_command, "swaybg") != 0;
+}
+
+/**
+ * Builds the command line for the shared swaybg, or returns NULL if no output
+ * has a background.
+ */
+static char *get_swaybg_command(void) {
+	size_t len = strlen(config->swaybg_command);
+	int count = 0;
+	for (int i = 0; i < root->outputs->length; ++i) {
+		struct sway_output *output = root->outputs->items[i];
+		if (output->bg_args) {
+			len += snprintf(NULL, 0, " %d %s%s", i, output->bg_args,
+					output->bg_fallback ? "" : " -");
+			++count;
+		}
+	}
+	if (count == 0) {
+		return NULL;
+	}
+	char *command = malloc(len + 1);
+	if (!command) {
+		wlr_log(WLR_DEBUG, "Unable to allocate swaybg command");
+		return NULL;
+	}
+	char *pos = command + sprintf(command, "%s", config->swaybg_command);
+	for (int i = 0; i < root->outputs->length; ++i) {
+		struct sway_output *output = root->outputs->items[i];
+		if (output->bg_args) {
+			pos += sprintf(pos, " %d %s%s", i, output->bg_args,
+					output->bg_fallback ? "" : " -");
+		}
+	}
+	return command;
+}
+
+static char *get_output_swaybg_command(struct sway_output *output, int index) {
+	if (!output->bg_args) {
+		return NULL;
+	}
+	size_t len = snprintf(NULL, 0, "%s %d %s",
+			config->swaybg_command, index, output->bg_args);
+	char *command = malloc(len + 1);
+	if (!command) {
+		wlr_log(WLR_DEBUG, "Unable to allocate swaybg command");
+		return NULL;
+	}
+	snprintf(command, len + 1, "%s %d %s",
+			config->swaybg_command, index, output->bg_args);
+	return command;
+}
+
+/**
+ * Replaces the swaybg in *pid, started as *running, with one running command,
+ * or with none if command is NULL. Takes ownership of command. Most output
+ * changes (dpms, mode, scale) leave the command line alone, in which case the
+ * running swaybg is kept rather than flashing its outputs.
+ */
+static void restart_swaybg(pid_t *pid, char **running, char *command) {
+	if (*pid != 0 && waitpid(*pid, NULL, WNOHANG) == *pid) {
+		*pid = 0; // It exited on its own, so restart it
+	}
+	if (*pid != 0 && command && *running && strcmp(command, *running) == 0) {
+		free(command);
+		return;
+	}
+
+	if (*pid != 0) {
+		terminate_swaybg(*pid);
+		*pid = 0;
+	}
+	free(*running);
+	*running = NULL;
+	if (!command) {
+		return;
+	}
+	wlr_log(WLR_DEBUG, "-> %s", command);
+
+	char *const cmd[] = { "sh", "-c", command, NULL };
+	*pid = fork();
+	if (*pid == 0) {
+		execvp(cmd[0], cmd);
+		_exit(EXIT_FAILURE);
+	} else if (*pid < 0) {
+		wlr_log_errno(WLR_ERROR, "Unable to fork swaybg");
+		*pid = 0;
+		free(command);
+	} else {
+		*running = command;
+	}
+}
+
+static void spawn_swaybg(void *data) {
+	swaybg_idle = NULL;
+	bool custom = swaybg_is_custom();
+	restart_swaybg(&swaybg_pid, &swaybg_running_command,
+			config->swaybg_command && !custom ? get_swaybg_command() : NULL);
+	for (int i = 0; i < root->outputs->length; ++i) {
+		struct sway_output *output = root->outputs->items[i];
+		restart_swaybg(&output->bg_pid, &output->bg_command,
+				custom ? get_output_swaybg_command(output, i) : NULL);
+	}
+}
+
+void output_terminate_swaybg(struct sway_output *output) {
+	restart_swaybg(&output->bg_pid, &output->bg_command, NULL);
+}
+
+void update_swaybg(void) {
+	if (!swaybg_idle) {
+		swaybg_idle = wl_event_loop_add_idle(server.wl_event_loop,
+				spawn_swaybg, NULL);
+	}
+}
+
 void apply_output_config(struct output_config *oc, struct sway_output *output) {
 	struct wlr_output *wlr_output = output->wlr_output;
 
 	if (oc && oc->enabled == 0) {
 		if (output->enabled) {
-			if (output->bg_pid != 0) {
-				terminate_swaybg(output->bg_pid);
-				output->bg_pid = 0;
-			}
 			output_disable(output);
 			wlr_output_layout_remove(root->output_layout, wlr_output);
 		}
@@ -222,43 +348,25 @@ void apply_output_config(struct output_config *oc, struct sway_output *output) {
 		wlr_output_layout_add_auto(root->output_layout, wlr_output);
 	}
 
-	int output_i;
-	for (output_i = 0; output_i < root->outputs->length; ++output_i) {
-		if (root->outputs->items[output_i] == output) {
-			break;
-		}
-	}
+	free(output->bg_args);
+	output->bg_args = NULL;
+	if (oc && oc->background) {
+		wlr_log(WLR_DEBUG, "Setting background for output %s to %s",
+				output->wlr_output->name, oc->background);
 
-	if (output->bg_pid != 0) {
-		terminate_swaybg(output->bg_pid);
-	}
-	if (oc && oc->background && config->swaybg_command) {
-		wlr_log(WLR_DEBUG, "Setting background for output %d to %s",
-				output_i, oc->background);
-
-		size_t len = snprintf(NULL, 0, "%s %d \"%s\" %s %s",
-				config->swaybg_command, output_i, oc->background,
-				oc->background_option,
-				oc->background_fallback ? oc->background_fallback : "");
-		char *command = malloc(len + 1);
-		if (!command) {
-			wlr_log(WLR_DEBUG, "Unable to allocate swaybg command");
-			return;
-		}
-		snprintf(command, len + 1, "%s %d \"%s\" %s %s",
-				config->swaybg_command, output_i, oc->background,
-				oc->background_option,
-				oc->background_fallback ? oc->background_fallback : "");
-		wlr_log(WLR_DEBUG, "-> %s", command);
-
-		char *const cmd[] = { "sh", "-c", command, NULL };
-		output->bg_pid = fork();
-		if (output->bg_pid == 0) {
-			execvp(cmd[0], cmd);
-		} else {
-			free(command);
+		const char *fallback =
+			oc->background_fallback ? oc->background_fallback : "";
+		size_t len = snprintf(NULL, 0, "\"%s\" %s%s%s", oc->background,
+				oc->background_option, *fallback ? " " : "", fallback);
+		output->bg_args = malloc(len + 1);
+		if (output->bg_args) {
+			snprintf(output->bg_args, len + 1, "\"%s\" %s%s%s",
+					oc->background, oc->background_option,
+					*fallback ? " " : "", fallback);
 		}
+		output->bg_fallback = *fallback;
 	}
+	update_swaybg();
 
 	if (oc) {
 		switch (oc->dpms_state) {
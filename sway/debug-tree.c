@@ -4,6 +4,7 @@
 #include <wlr/util/log.h>
 #include "config.h"
 #include "sway/debug.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/output.h"
@@ -16,6 +17,7 @@
 #include "pango.h"
 
 struct sway_debug debug;
+struct sway_debug_stats debug_stats;
 
 static const char *layout_to_str(enum sway_container_layout layout) {
 	switch (layout) {
@@ -120,6 +122,25 @@ static int draw_node(cairo_t *cairo, struct sway_node *node,
 	return height;
 }
 
+struct stats_position {
+	cairo_t *cairo;
+	int y;
+};
+
+static void draw_dispatch_stats(struct dispatch_stats *stats, void *data) {
+	struct stats_position *pos = data;
+	char buffer[128];
+	snprintf(buffer, sizeof(buffer), "%s: %lu calls %.1fms total %.1fms max",
+			stats->name, (unsigned long)stats->count,
+			stats->total_ns / 1000000.0, stats->max_ns / 1000000.0);
+	int text_width, text_height;
+	get_text_size(pos->cairo, "monospace", &text_width, &text_height, NULL,
+		1, false, buffer);
+	cairo_move_to(pos->cairo, 0, pos->y);
+	pango_printf(pos->cairo, "monospace", 1, false, buffer);
+	pos->y += text_height;
+}
+
 void update_debug_tree(void) {
 	if (!debug.render_tree) {
 		return;
@@ -144,7 +165,20 @@ void update_debug_tree(void) {
 	struct sway_node *focus = seat_get_focus(seat);
 
 	cairo_set_source_u32(cairo, 0x000000FF);
-	draw_node(cairo, &root->node, focus, 0, 0);
+	int tree_height = draw_node(cairo, &root->node, focus, 0, 0);
+
+	cairo_set_source_u32(cairo, 0x000000FF);
+	cairo_move_to(cairo, 0, tree_height);
+	pango_printf(cairo, "monospace", 1, false,
+			"txn allocs:%zu reuses:%zu arrange skips:%zu",
+			debug_stats.txn_allocs, debug_stats.txn_reuses,
+			debug_stats.arrange_skips);
+
+	int text_width, text_height;
+	get_text_size(cairo, "monospace", &text_width, &text_height, NULL,
+		1, false, "txn");
+	struct stats_position pos = { cairo, tree_height + text_height };
+	dispatch_for_each_stats(draw_dispatch_stats, &pos);
 
 	cairo_surface_flush(surface);
 	struct wlr_renderer *renderer = wlr_backend_get_renderer(server.backend);
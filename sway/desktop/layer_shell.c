@@ -8,6 +8,7 @@
 #include <wlr/types/wlr_output.h>
 #include <wlr/util/log.h>
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/layers.h"
@@ -262,6 +263,10 @@ static void handle_output_destroy(struct wl_listener *listener, void *data) {
 	wlr_layer_surface_v1_close(sway_layer->layer_surface);
 }
 
+static struct dispatch_stats commit_dispatch = {
+	.name = "layer_shell commit",
+};
+
 static void handle_surface_commit(struct wl_listener *listener, void *data) {
 	struct sway_layer_surface *layer =
 		wl_container_of(listener, layer, surface_commit);
@@ -270,6 +275,7 @@ static void handle_surface_commit(struct wl_listener *listener, void *data) {
 	if (wlr_output == NULL) {
 		return;
 	}
+	uint64_t start = dispatch_begin();
 
 	struct sway_output *output = wlr_output->data;
 	struct wlr_box old_geo = layer->geo;
@@ -285,6 +291,7 @@ static void handle_surface_commit(struct wl_listener *listener, void *data) {
 	}
 
 	transaction_commit_dirty();
+	dispatch_end(&commit_dispatch, start);
 }
 
 static void unmap(struct sway_layer_surface *sway_layer) {
@@ -17,6 +17,7 @@
 #include "config.h"
 #include "sway/config.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/layers.h"
@@ -239,6 +240,31 @@ struct sway_workspace *output_get_active_workspace(struct sway_output *output) {
 	return focus->sway_workspace;
 }
 
+static void collect_visible_view(struct sway_container *con, void *data) {
+	list_t *views = data;
+	if (con->view && view_is_visible(con->view)) {
+		list_add(views, con->view);
+	}
+}
+
+/**
+ * Rebuild the list of views which are visible on the output. This is used to
+ * send frame done events, so that each frame only costs as much as the number
+ * of visible views rather than every view on the workspace.
+ *
+ * Views are only hidden or revealed as part of a transaction, so this is
+ * called whenever a transaction is applied.
+ */
+void output_update_visible_views(struct sway_output *output) {
+	output->visible_views->length = 0;
+	if (!output->enabled || !output->workspaces->length) {
+		return;
+	}
+	struct sway_workspace *workspace = output_get_active_workspace(output);
+	workspace_for_each_container(workspace,
+			collect_visible_view, output->visible_views);
+}
+
 bool output_has_opaque_overlay_layer_surface(struct sway_output *output) {
 	struct wlr_layer_surface_v1 *wlr_layer_surface_v1;
 	wl_list_for_each(wlr_layer_surface_v1, &server.layer_shell->surfaces, link) {
@@ -295,66 +321,29 @@ static void send_frame_done_drag_icons(struct sway_output *output,
 		send_frame_done_iterator, when);
 }
 
-struct send_frame_done_data {
-	struct sway_output *output;
-	struct timespec *when;
-};
-
-static void send_frame_done_container_iterator(struct sway_container *con,
-		void *_data) {
-	if (!con->view) {
-		return;
-	}
-	if (!view_is_visible(con->view)) {
-		return;
-	}
-
-	struct send_frame_done_data *data = _data;
-	output_view_for_each_surface(data->output, con->view,
-		send_frame_done_iterator, data->when);
-}
-
 static void send_frame_done(struct sway_output *output, struct timespec *when) {
 	if (output_has_opaque_overlay_layer_surface(output)) {
 		goto send_frame_overlay;
 	}
 
-	struct send_frame_done_data data = {
-		.output = output,
-		.when = when,
-	};
+	for (int i = 0; i < output->visible_views->length; ++i) {
+		struct sway_view *view = output->visible_views->items[i];
+		output_view_for_each_surface(output, view,
+			send_frame_done_iterator, when);
+	}
+
 	struct sway_workspace *workspace = output_get_active_workspace(output);
-	if (workspace->current.fullscreen) {
-		send_frame_done_container_iterator(
-				workspace->current.fullscreen, &data);
-		container_for_each_child(workspace->current.fullscreen,
-				send_frame_done_container_iterator, &data);
-		for (int i = 0; i < workspace->current.floating->length; ++i) {
-			struct sway_container *floater =
-				workspace->current.floating->items[i];
-			if (container_is_transient_for(floater,
-						workspace->current.fullscreen)) {
-				send_frame_done_container_iterator(floater, &data);
-			}
-		}
-#ifdef HAVE_XWAYLAND
-		send_frame_done_unmanaged(output, &root->xwayland_unmanaged, when);
-#endif
-	} else {
+	if (!workspace->current.fullscreen) {
 		send_frame_done_layer(output,
 			&output->layers[ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND], when);
 		send_frame_done_layer(output,
 			&output->layers[ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM], when);
-
-		workspace_for_each_container(workspace,
-				send_frame_done_container_iterator, &data);
-
-#ifdef HAVE_XWAYLAND
-		send_frame_done_unmanaged(output, &root->xwayland_unmanaged, when);
-#endif
 		send_frame_done_layer(output,
 			&output->layers[ZWLR_LAYER_SHELL_V1_LAYER_TOP], when);
 	}
+#ifdef HAVE_XWAYLAND
+	send_frame_done_unmanaged(output, &root->xwayland_unmanaged, when);
+#endif
 
 send_frame_overlay:
 	send_frame_done_layer(output,
@@ -362,6 +351,8 @@ send_frame_overlay:
 	send_frame_done_drag_icons(output, &root->drag_icons, when);
 }
 
+static struct dispatch_stats frame_dispatch = { .name = "output frame" };
+
 static void damage_handle_frame(struct wl_listener *listener, void *data) {
 	struct sway_output *output =
 		wl_container_of(listener, output, damage_frame);
@@ -370,6 +361,8 @@ static void damage_handle_frame(struct wl_listener *listener, void *data) {
 		return;
 	}
 
+	uint64_t start = dispatch_begin();
+
 	struct timespec now;
 	clock_gettime(CLOCK_MONOTONIC, &now);
 
@@ -377,6 +370,7 @@ static void damage_handle_frame(struct wl_listener *listener, void *data) {
 	pixman_region32_t damage;
 	pixman_region32_init(&damage);
 	if (!wlr_output_damage_make_current(output->damage, &needs_swap, &damage)) {
+		dispatch_end(&frame_dispatch, start);
 		return;
 	}
 
@@ -388,6 +382,7 @@ static void damage_handle_frame(struct wl_listener *listener, void *data) {
 
 	// Send frame done to all visible surfaces
 	send_frame_done(output, &now);
+	dispatch_end(&frame_dispatch, start);
 }
 
 void output_damage_whole(struct sway_output *output) {
@@ -541,13 +536,17 @@ static void handle_scale(struct wl_listener *listener, void *data) {
 	transaction_commit_dirty();
 }
 
+static struct dispatch_stats new_output_dispatch = { .name = "new output" };
+
 void handle_new_output(struct wl_listener *listener, void *data) {
 	struct sway_server *server = wl_container_of(listener, server, new_output);
 	struct wlr_output *wlr_output = data;
 	wlr_log(WLR_DEBUG, "New output %p: %s", wlr_output, wlr_output->name);
 
+	uint64_t start = dispatch_begin();
 	struct sway_output *output = output_create(wlr_output);
 	if (!output) {
+		dispatch_end(&new_output_dispatch, start);
 		return;
 	}
 	output->server = server;
@@ -561,6 +560,7 @@ void handle_new_output(struct wl_listener *listener, void *data) {
 	}
 
 	transaction_commit_dirty();
+	dispatch_end(&new_output_dispatch, start);
 }
 
 void output_add_listeners(struct sway_output *output) {
@@ -22,6 +22,7 @@
 #include "sway/layers.h"
 #include "sway/output.h"
 #include "sway/server.h"
+#include "sway/trace.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/container.h"
 #include "sway/tree/root.h"
@@ -919,6 +920,7 @@ void output_render(struct sway_output *output, struct timespec *when,
 		return;
 	}
 
+	uint64_t trace_start = trace_begin();
 	wlr_renderer_begin(renderer, wlr_output->width, wlr_output->height);
 
 	if (!pixman_region32_not_empty(damage)) {
@@ -1023,7 +1025,10 @@ renderer_end:
 
 	wlr_renderer_scissor(renderer, NULL);
 	wlr_renderer_end(renderer);
-	if (!wlr_output_damage_swap_buffers(output->damage, when, damage)) {
+	bool swapped =
+		wlr_output_damage_swap_buffers(output->damage, when, damage);
+	trace_end(trace_start, "output_render", wlr_output->name);
+	if (!swapped) {
 		return;
 	}
 	output->last_frame = *when;
@@ -11,9 +11,12 @@
 #include "sway/desktop.h"
 #include "sway/desktop/idle_inhibit_v1.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/output.h"
+#include "sway/trace.h"
 #include "sway/tree/container.h"
 #include "sway/tree/node.h"
+#include "sway/tree/root.h"
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
 #include "list.h"
@@ -38,13 +41,86 @@ struct sway_transaction_instruction {
 	uint32_t serial;
 };
 
+/**
+ * Transactions, instructions and the state lists they carry are recycled
+ * rather than freed, so that committing and applying transactions doesn't
+ * touch the allocator once the pools have warmed up. Each pool is capped so a
+ * one-off burst doesn't pin memory forever.
+ */
+#define TXN_POOL_MAX 512
+
+static list_t *free_transactions;  // struct sway_transaction *
+static list_t *free_instructions;  // struct sway_transaction_instruction *
+static list_t *free_state_lists;   // list_t *
+
+static void *pool_take(list_t *pool) {
+	if (!pool || !pool->length) {
+		return NULL;
+	}
+	return pool->items[--pool->length];
+}
+
+static bool pool_give(list_t **pool, void *item) {
+	if (!*pool) {
+		*pool = create_list();
+	}
+	if ((*pool)->length >= TXN_POOL_MAX) {
+		return false;
+	}
+	list_add(*pool, item);
+	return true;
+}
+
+static list_t *state_list_copy(list_t *source) {
+	list_t *list = pool_take(free_state_lists);
+	if (list) {
+		list->length = 0;
+		debug_stats.txn_reuses++;
+	} else {
+		list = create_list();
+		debug_stats.txn_allocs++;
+	}
+	list_cat(list, source);
+	return list;
+}
+
+static void state_list_release(list_t *list) {
+	if (list && !pool_give(&free_state_lists, list)) {
+		list_free(list);
+	}
+}
+
+static struct sway_transaction_instruction *instruction_create(void) {
+	struct sway_transaction_instruction *instruction =
+		pool_take(free_instructions);
+	if (instruction) {
+		memset(instruction, 0, sizeof(struct sway_transaction_instruction));
+		debug_stats.txn_reuses++;
+		return instruction;
+	}
+	debug_stats.txn_allocs++;
+	return calloc(1, sizeof(struct sway_transaction_instruction));
+}
+
+static void instruction_release(
+		struct sway_transaction_instruction *instruction) {
+	if (!pool_give(&free_instructions, instruction)) {
+		free(instruction);
+	}
+}
+
 static struct sway_transaction *transaction_create(void) {
-	struct sway_transaction *transaction =
-		calloc(1, sizeof(struct sway_transaction));
+	struct sway_transaction *transaction = pool_take(free_transactions);
+	if (transaction) {
+		debug_stats.txn_reuses++;
+		return transaction;
+	}
+	transaction = calloc(1, sizeof(struct sway_transaction));
 	if (!sway_assert(transaction, "Unable to allocate transaction")) {
 		return NULL;
 	}
 	transaction->instructions = create_list();
+	debug_stats.txn_allocs++;
 	return transaction;
 }
 
@@ -74,10 +150,21 @@ static void transaction_destroy(struct sway_transaction *transaction) {
 				break;
 			}
 		}
-		free(instruction);
+		instruction_release(instruction);
 	}
-	list_free(transaction->instructions);
+	transaction->instructions->length = 0;
 
+	// The timer is kept with a recycled transaction, but must not fire
+	if (transaction->timer) {
+		wl_event_source_timer_update(transaction->timer, 0);
+	}
+	transaction->num_waiting = 0;
+	transaction->num_configures = 0;
+	if (pool_give(&free_transactions, transaction)) {
+		return;
+	}
+
+	list_free(transaction->instructions);
 	if (transaction->timer) {
 		wl_event_source_remove(transaction->timer);
 	}
@@ -87,8 +174,7 @@ static void transaction_destroy(struct sway_transaction *transaction) {
 static void copy_output_state(struct sway_output *output,
 		struct sway_transaction_instruction *instruction) {
 	struct sway_output_state *state = &instruction->output_state;
-	state->workspaces = create_list();
-	list_cat(state->workspaces, output->workspaces);
+	state->workspaces = state_list_copy(output->workspaces);
 
 	state->active_workspace = output_get_active_workspace(output);
 }
@@ -105,10 +191,8 @@ static void copy_workspace_state(struct sway_workspace *ws,
 	state->layout = ws->layout;
 
 	state->output = ws->output;
-	state->floating = create_list();
-	state->tiling = create_list();
-	list_cat(state->floating, ws->floating);
-	list_cat(state->tiling, ws->tiling);
+	state->floating = state_list_copy(ws->floating);
+	state->tiling = state_list_copy(ws->tiling);
 
 	struct sway_seat *seat = input_manager_current_seat(input_manager);
 	state->focused = seat_get_focus(seat) == &ws->node;
@@ -149,8 +233,7 @@ static void copy_container_state(struct sway_container *container,
 		state->border_right = view->border_right;
 		state->border_bottom = view->border_bottom;
 	} else {
-		state->children = create_list();
-		list_cat(state->children, container->children);
+		state->children = state_list_copy(container->children);
 	}
 
 	struct sway_seat *seat = input_manager_current_seat(input_manager);
@@ -165,8 +248,7 @@ static void copy_container_state(struct sway_container *container,
 
 static void transaction_add_node(struct sway_transaction *transaction,
 		struct sway_node *node) {
-	struct sway_transaction_instruction *instruction =
-		calloc(1, sizeof(struct sway_transaction_instruction));
+	struct sway_transaction_instruction *instruction = instruction_create();
 	if (!sway_assert(instruction, "Unable to allocate instruction")) {
 		return;
 	}
@@ -194,7 +276,7 @@ static void transaction_add_node(struct sway_transaction *transaction,
 static void apply_output_state(struct sway_output *output,
 		struct sway_output_state *state) {
 	output_damage_whole(output);
-	list_free(output->current.workspaces);
+	state_list_release(output->current.workspaces);
 	memcpy(&output->current, state, sizeof(struct sway_output_state));
 	output_damage_whole(output);
 }
@@ -202,8 +284,8 @@ static void apply_output_state(struct sway_output *output,
 static void apply_workspace_state(struct sway_workspace *ws,
 		struct sway_workspace_state *state) {
 	output_damage_whole(ws->current.output);
-	list_free(ws->current.floating);
-	list_free(ws->current.tiling);
+	state_list_release(ws->current.floating);
+	state_list_release(ws->current.tiling);
 	memcpy(&ws->current, state, sizeof(struct sway_workspace_state));
 	output_damage_whole(ws->current.output);
 }
@@ -225,10 +307,10 @@ static void apply_container_state(struct sway_container *container,
 
 	// There are separate children lists for each instruction state, the
 	// container's current state and the container's pending state
-	// (ie. con->children). The list itself needs to be freed here.
+	// (ie. con->children). The list itself needs to be released here.
 	// Any child containers which are being deleted will be cleaned up in
 	// transaction_destroy().
-	list_free(container->current.children);
+	state_list_release(container->current.children);
 
 	memcpy(&container->current, state, sizeof(struct sway_container_state));
 
@@ -260,6 +342,7 @@ static void apply_container_state(struct sway_container *container,
  * Apply a transaction to the "current" state of the tree.
  */
 static void transaction_apply(struct sway_transaction *transaction) {
+	uint64_t trace_start = trace_begin();
 	wlr_log(WLR_DEBUG, "Applying transaction %p", transaction);
 	if (debug.txn_timings) {
 		struct timespec now;
@@ -269,6 +352,10 @@ static void transaction_apply(struct sway_transaction *transaction) {
 			(now.tv_nsec - commit->tv_nsec) / 1000000.0;
 		wlr_log(WLR_DEBUG, "Transaction %p: %.1fms waiting "
 				"(%.1f frames if 60Hz)", transaction, ms, ms / (1000.0f / 60));
+		wlr_log(WLR_DEBUG, "Transaction pools: %zu allocations, %zu reuses",
+				debug_stats.txn_allocs, debug_stats.txn_reuses);
+		wlr_log(WLR_DEBUG, "Arrange: %zu unchanged nodes skipped",
+				debug_stats.arrange_skips);
 	}
 
 	// Apply the instruction state to the node's current state
@@ -295,69 +382,119 @@ static void transaction_apply(struct sway_transaction *transaction) {
 
 		node->instruction = NULL;
 	}
+
+	for (int i = 0; i < root->outputs->length; ++i) {
+		output_update_visible_views(root->outputs->items[i]);
+	}
+	trace_end(trace_start, "transaction_apply", NULL);
 }
 
 static void transaction_commit(struct sway_transaction *transaction);
 
-// Return true if both transactions operate on the same nodes
-static bool transaction_same_nodes(struct sway_transaction *a,
-		struct sway_transaction *b) {
-	if (a->instructions->length != b->instructions->length) {
-		return false;
+static void instruction_free_state(
+		struct sway_transaction_instruction *instruction) {
+	switch (instruction->node->type) {
+	case N_ROOT:
+		break;
+	case N_OUTPUT:
+		state_list_release(instruction->output_state.workspaces);
+		break;
+	case N_WORKSPACE:
+		state_list_release(instruction->workspace_state.floating);
+		state_list_release(instruction->workspace_state.tiling);
+		break;
+	case N_CONTAINER:
+		state_list_release(instruction->container_state.children);
+		break;
 	}
-	for (int i = 0; i < a->instructions->length; ++i) {
-		struct sway_transaction_instruction *a_inst = a->instructions->items[i];
-		struct sway_transaction_instruction *b_inst = b->instructions->items[i];
-		if (a_inst->node != b_inst->node) {
-			return false;
+}
+
+static struct sway_transaction_instruction *transaction_find_instruction(
+		struct sway_transaction *transaction, struct sway_node *node) {
+	for (int i = 0; i < transaction->instructions->length; ++i) {
+		struct sway_transaction_instruction *instruction =
+			transaction->instructions->items[i];
+		if (instruction->node == node) {
+			return instruction;
 		}
 	}
-	return true;
+	return NULL;
 }
 
-static void transaction_progress_queue(void) {
-	if (!server.transactions->length) {
-		return;
+/**
+ * Fold the instructions of an uncommitted transaction into another uncommitted
+ * transaction, keeping the latest state for each node. Applying the result is
+ * equivalent to applying dest and then src. The src transaction is destroyed.
+ */
+static void transaction_merge(struct sway_transaction *dest,
+		struct sway_transaction *src) {
+	wlr_log(WLR_DEBUG, "Merging transaction %p into %p", src, dest);
+	for (int i = 0; i < src->instructions->length; ++i) {
+		struct sway_transaction_instruction *instruction =
+			src->instructions->items[i];
+		struct sway_transaction_instruction *existing =
+			transaction_find_instruction(dest, instruction->node);
+		if (!existing) {
+			instruction->transaction = dest;
+			list_add(dest->instructions, instruction);
+			continue;
+		}
+		// The existing instruction keeps its reference to the node
+		instruction_free_state(existing);
+		switch (instruction->node->type) {
+		case N_ROOT:
+			break;
+		case N_OUTPUT:
+			existing->output_state = instruction->output_state;
+			break;
+		case N_WORKSPACE:
+			existing->workspace_state = instruction->workspace_state;
+			break;
+		case N_CONTAINER:
+			existing->container_state = instruction->container_state;
+			break;
+		}
+		instruction->node->ntxnrefs--;
+		instruction_release(instruction);
 	}
-	// There's only ever one committed transaction,
-	// and it's the first one in the queue.
-	struct sway_transaction *transaction = server.transactions->items[0];
-	if (transaction->num_waiting) {
+	src->instructions->length = 0;
+	transaction_destroy(src);
+}
+
+static void transaction_progress_queue(void) {
+	struct sway_transaction *transaction = server.committed_transaction;
+	if (!transaction || transaction->num_waiting) {
 		return;
 	}
 	transaction_apply(transaction);
 	transaction_destroy(transaction);
-	list_del(server.transactions, 0);
+	server.committed_transaction = NULL;
 
-	if (!server.transactions->length) {
+	if (!server.queued_transaction) {
 		idle_inhibit_v1_check_active(server.idle_inhibit_manager_v1);
 		return;
 	}
 
-	// If there's a bunch of consecutive transactions which all apply to the
-	// same views, skip all except the last one.
-	while (server.transactions->length >= 2) {
-		struct sway_transaction *a = server.transactions->items[0];
-		struct sway_transaction *b = server.transactions->items[1];
-		if (transaction_same_nodes(a, b)) {
-			list_del(server.transactions, 0);
-			transaction_destroy(a);
-		} else {
-			break;
-		}
-	}
-
-	transaction = server.transactions->items[0];
-	transaction_commit(transaction);
+	// Anything queued behind the committed transaction has already been merged
+	// into a single transaction by transaction_commit_dirty.
+	server.committed_transaction = server.queued_transaction;
+	server.queued_transaction = NULL;
+	transaction_commit(server.committed_transaction);
 	transaction_progress_queue();
 }
 
+static struct dispatch_stats timeout_dispatch = {
+	.name = "transaction timeout",
+};
+
 static int handle_timeout(void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_transaction *transaction = data;
 	wlr_log(WLR_DEBUG, "Transaction %p timed out (%li waiting)",
 			transaction, transaction->num_waiting);
 	transaction->num_waiting = 0;
 	transaction_progress_queue();
+	dispatch_end(&timeout_dispatch, start);
 	return 0;
 }
 
@@ -389,6 +526,7 @@ static bool should_configure(struct sway_node *node,
 }
 
 static void transaction_commit(struct sway_transaction *transaction) {
+	uint64_t trace_start = trace_begin();
 	wlr_log(WLR_DEBUG, "Transaction %p committing with %i instructions",
 			transaction, transaction->instructions->length);
 	transaction->num_waiting = 0;
@@ -433,9 +571,12 @@ static void transaction_commit(struct sway_transaction *transaction) {
 	}
 
 	if (transaction->num_waiting) {
-		// Set up a timer which the views must respond within
-		transaction->timer = wl_event_loop_add_timer(server.wl_event_loop,
-				handle_timeout, transaction);
+		// Set up a timer which the views must respond within. Recycled
+		// transactions already have one.
+		if (!transaction->timer) {
+			transaction->timer = wl_event_loop_add_timer(server.wl_event_loop,
+					handle_timeout, transaction);
+		}
 		if (transaction->timer) {
 			wl_event_source_timer_update(transaction->timer,
 					server.txn_timeout_ms);
@@ -451,6 +592,7 @@ static void transaction_commit(struct sway_transaction *transaction) {
 	// update it, because we make a transaction every time we change the pending
 	// tree.
 	update_debug_tree();
+	trace_end(trace_start, "transaction_commit", NULL);
 }
 
 static void set_instruction_ready(
@@ -514,14 +656,24 @@ void transaction_commit_dirty(void) {
 	}
 	server.dirty_nodes->length = 0;
 
-	list_add(server.transactions, transaction);
+	// If a transaction is already waiting behind the committed one, merge into
+	// it rather than queueing another. This keeps the queue at most two long
+	// during rapid changes such as interactive resizing, and means we only
+	// ever configure views with the latest layout.
+	if (server.queued_transaction) {
+		transaction_merge(server.queued_transaction, transaction);
+		return;
+	}
 
-	// There's only ever one committed transaction,
-	// and it's the first one in the queue.
-	if (server.transactions->length == 1) {
-		transaction_commit(transaction);
-		// Attempting to progress the queue here is useful
-		// if the transaction has nothing to wait for.
-		transaction_progress_queue();
+	if (server.committed_transaction) {
+		server.queued_transaction = transaction;
+		return;
 	}
+
+	// There's only ever one committed transaction
+	server.committed_transaction = transaction;
+	transaction_commit(transaction);
+	// Attempting to progress the queue here is useful
+	// if the transaction has nothing to wait for.
+	transaction_progress_queue();
 }
@@ -9,6 +9,7 @@
 #include "sway/decoration.h"
 #include "sway/desktop.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/output.h"
@@ -269,7 +270,10 @@ static const struct sway_view_impl view_impl = {
 	.destroy = destroy,
 };
 
+static struct dispatch_stats commit_dispatch = { .name = "xdg_shell commit" };
+
 static void handle_commit(struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_xdg_shell_view *xdg_shell_view =
 		wl_container_of(listener, xdg_shell_view, commit);
 	struct sway_view *view = &xdg_shell_view->view;
@@ -297,6 +301,7 @@ static void handle_commit(struct wl_listener *listener, void *data) {
 	}
 
 	view_damage_from(view);
+	dispatch_end(&commit_dispatch, start);
 }
 
 static void handle_set_title(struct wl_listener *listener, void *data) {
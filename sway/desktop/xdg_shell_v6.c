@@ -8,6 +8,7 @@
 #include "sway/decoration.h"
 #include "sway/desktop.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/output.h"
@@ -266,7 +267,12 @@ static const struct sway_view_impl view_impl = {
 	.destroy = destroy,
 };
 
+static struct dispatch_stats commit_dispatch = {
+	.name = "xdg_shell_v6 commit",
+};
+
 static void handle_commit(struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_xdg_shell_v6_view *xdg_shell_v6_view =
 		wl_container_of(listener, xdg_shell_v6_view, commit);
 	struct sway_view *view = &xdg_shell_v6_view->view;
@@ -294,6 +300,7 @@ static void handle_commit(struct wl_listener *listener, void *data) {
 	}
 
 	view_damage_from(view);
+	dispatch_end(&commit_dispatch, start);
 }
 
 static void handle_set_title(struct wl_listener *listener, void *data) {
@@ -8,6 +8,7 @@
 #include "log.h"
 #include "sway/desktop.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/output.h"
@@ -308,7 +309,10 @@ static void get_geometry(struct sway_view *view, struct wlr_box *box) {
 	}
 }
 
+static struct dispatch_stats commit_dispatch = { .name = "xwayland commit" };
+
 static void handle_commit(struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_xwayland_view *xwayland_view =
 		wl_container_of(listener, xwayland_view, commit);
 	struct sway_view *view = &xwayland_view->view;
@@ -338,6 +342,7 @@ static void handle_commit(struct wl_listener *listener, void *data) {
 	}
 
 	view_damage_from(view);
+	dispatch_end(&commit_dispatch, start);
 }
 
 static void handle_destroy(struct wl_listener *listener, void *data) {
@@ -0,0 +1,62 @@
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "sway/debug.h"
+#include "sway/dispatch.h"
+#include "log.h"
+
+static struct wl_list all_stats = { &all_stats, &all_stats };
+
+uint64_t dispatch_begin(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void dispatch_end(struct dispatch_stats *stats, uint64_t start) {
+	uint64_t elapsed = dispatch_begin() - start;
+	if (!stats->link.next) {
+		wl_list_insert(all_stats.prev, &stats->link);
+	}
+	++stats->count;
+	stats->total_ns += elapsed;
+	if (elapsed > stats->max_ns) {
+		stats->max_ns = elapsed;
+	}
+	if (debug.dispatch_threshold_ms > 0 &&
+			elapsed > (uint64_t)debug.dispatch_threshold_ms * 1000000) {
+		wlr_log(WLR_INFO, "Slow dispatch: %s took %.1fms",
+				stats->name, elapsed / 1000000.0);
+	}
+}
+
+static void log_stats(struct dispatch_stats *stats, enum wlr_log_importance level) {
+	wlr_log(level, "Dispatch: %s: %lu calls, %.1fms total, "
+			"%.3fms mean, %.1fms max", stats->name, (unsigned long)stats->count,
+			stats->total_ns / 1000000.0,
+			stats->count ? stats->total_ns / 1000000.0 / stats->count : 0.0,
+			stats->max_ns / 1000000.0);
+}
+
+void dispatch_stats_finish(struct dispatch_stats *stats) {
+	if (!stats->link.next) {
+		return;
+	}
+	log_stats(stats, WLR_DEBUG);
+	wl_list_remove(&stats->link);
+	stats->link.next = stats->link.prev = NULL;
+}
+
+void dispatch_log_stats(void) {
+	struct dispatch_stats *stats;
+	wl_list_for_each(stats, &all_stats, link) {
+		log_stats(stats, WLR_INFO);
+	}
+}
+
+void dispatch_for_each_stats(void (*f)(struct dispatch_stats *stats,
+			void *data), void *data) {
+	struct dispatch_stats *stats;
+	wl_list_for_each(stats, &all_stats, link) {
+		f(stats, data);
+	}
+}
@@ -15,10 +15,13 @@
 #include "sway/commands.h"
 #include "sway/desktop.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/cursor.h"
 #include "sway/input/keyboard.h"
 #include "sway/layers.h"
 #include "sway/output.h"
+#include "sway/server.h"
+#include "sway/trace.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/container.h"
 #include "sway/tree/root.h"
@@ -542,8 +545,93 @@ static void handle_resize_tiling_motion(struct sway_seat *seat,
 	}
 }
 
-void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
+static void handle_resize_motion(struct sway_seat *seat,
+		struct sway_cursor *cursor) {
+	if (seat->operation == OP_RESIZE_FLOATING) {
+		handle_resize_floating_motion(seat, cursor);
+	} else {
+		handle_resize_tiling_motion(seat, cursor);
+	}
+	cursor->resize_last_msec = get_current_time_msec();
+}
+
+static uint32_t get_frame_interval_msec(struct wlr_output *wlr_output) {
+	int refresh = wlr_output ? wlr_output->refresh : 0;
+	if (refresh <= 0) {
+		return 16;
+	}
+	uint32_t interval = 1000000 / refresh;
+	return interval ? interval : 1;
+}
+
+/**
+ * Every interactive resize step commits a transaction and sends configures to
+ * the affected clients, and slow clients can't keep up with a high rate mouse.
+ * Resize straight away only if nothing is in flight and a frame has passed
+ * since the last step; otherwise remember that the cursor moved and resize to
+ * its latest position when the frame timer fires.
+ */
+static void queue_resize_motion(struct sway_seat *seat,
+		struct sway_cursor *cursor) {
+	if (cursor->resize_pending) {
+		return;
+	}
+	struct sway_workspace *ws = seat->op_container->workspace;
+	uint32_t interval = get_frame_interval_msec(
+			ws && ws->output ? ws->output->wlr_output : NULL);
+	uint32_t elapsed = get_current_time_msec() - cursor->resize_last_msec;
+	if (!server.committed_transaction && elapsed >= interval) {
+		handle_resize_motion(seat, cursor);
+		return;
+	}
+	cursor->resize_pending = true;
+	wl_event_source_timer_update(cursor->resize_timer,
+			elapsed < interval ? interval - elapsed : 1);
+}
+
+static void flush_resize_motion(struct sway_cursor *cursor) {
+	if (!cursor->resize_pending) {
+		return;
+	}
+	cursor->resize_pending = false;
+	wl_event_source_timer_update(cursor->resize_timer, 0);
+	struct sway_seat *seat = cursor->seat;
+	if (seat->operation == OP_RESIZE_FLOATING ||
+			seat->operation == OP_RESIZE_TILING) {
+		handle_resize_motion(seat, cursor);
+	}
+}
+
+static struct dispatch_stats resize_timer_dispatch = {
+	.name = "cursor resize timer",
+};
+static struct dispatch_stats motion_timer_dispatch = {
+	.name = "cursor motion timer",
+};
+static struct dispatch_stats motion_dispatch = { .name = "cursor motion" };
+static struct dispatch_stats button_dispatch = { .name = "cursor button" };
+
+static int handle_resize_timer(void *data) {
+	uint64_t start = dispatch_begin();
+	struct sway_cursor *cursor = data;
+	flush_resize_motion(cursor);
+	transaction_commit_dirty();
+	dispatch_end(&resize_timer_dispatch, start);
+	return 0;
+}
+
+static void send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 		bool allow_refocusing) {
+	if (cursor->motion_pending) {
+		cursor->motion_pending = false;
+		wl_event_source_timer_update(cursor->motion_timer, 0);
+		// The queued motion would have been allowed to refocus. If this one
+		// may not, send the queued one first so it keeps that behaviour,
+		// without granting it to the caller.
+		if (!allow_refocusing) {
+			send_pointer_motion(cursor, cursor->motion_time_msec, true);
+		}
+	}
 	if (time_msec == 0) {
 		time_msec = get_current_time_msec();
 	}
@@ -563,10 +651,8 @@ void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 			handle_move_tiling_motion(seat, cursor);
 			break;
 		case OP_RESIZE_FLOATING:
-			handle_resize_floating_motion(seat, cursor);
-			break;
 		case OP_RESIZE_TILING:
-			handle_resize_tiling_motion(seat, cursor);
+			queue_resize_motion(seat, cursor);
 			break;
 		case OP_NONE:
 			break;
@@ -661,25 +747,79 @@ void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 	}
 }
 
+void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
+		bool allow_refocusing) {
+	uint64_t trace_start = trace_begin();
+	send_pointer_motion(cursor, time_msec, allow_refocusing);
+	trace_end(trace_start, "cursor_motion", NULL);
+}
+
+/**
+ * With coalesce_pointer_motion enabled the cursor image follows every motion
+ * event, but hit testing, focus follows mouse and client motion events are
+ * handled at most once per frame of the output under the cursor. Anything
+ * which depends on the pointer position (buttons, axis events) flushes the
+ * queued motion first so ordering is preserved.
+ */
+static void queue_pointer_motion(struct sway_cursor *cursor,
+		uint32_t time_msec) {
+	cursor->motion_time_msec = time_msec;
+	if (cursor->motion_pending) {
+		return;
+	}
+	cursor->motion_pending = true;
+	struct wlr_output *wlr_output = wlr_output_layout_output_at(
+			root->output_layout, cursor->cursor->x, cursor->cursor->y);
+	wl_event_source_timer_update(cursor->motion_timer,
+			get_frame_interval_msec(wlr_output));
+}
+
+static void flush_pointer_motion(struct sway_cursor *cursor) {
+	if (cursor->motion_pending) {
+		cursor_send_pointer_motion(cursor, cursor->motion_time_msec, true);
+	}
+}
+
+static int handle_motion_timer(void *data) {
+	uint64_t start = dispatch_begin();
+	struct sway_cursor *cursor = data;
+	flush_pointer_motion(cursor);
+	transaction_commit_dirty();
+	dispatch_end(&motion_timer_dispatch, start);
+	return 0;
+}
+
 static void handle_cursor_motion(struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, motion);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_motion *event = data;
 	wlr_cursor_move(cursor->cursor, event->device,
 		event->delta_x, event->delta_y);
-	cursor_send_pointer_motion(cursor, event->time_msec, true);
-	transaction_commit_dirty();
+	if (config->coalesce_pointer_motion) {
+		queue_pointer_motion(cursor, event->time_msec);
+	} else {
+		cursor_send_pointer_motion(cursor, event->time_msec, true);
+		transaction_commit_dirty();
+	}
+	dispatch_end(&motion_dispatch, start);
 }
 
 static void handle_cursor_motion_absolute(
 		struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_cursor *cursor =
 		wl_container_of(listener, cursor, motion_absolute);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_motion_absolute *event = data;
 	wlr_cursor_warp_absolute(cursor->cursor, event->device, event->x, event->y);
-	cursor_send_pointer_motion(cursor, event->time_msec, true);
-	transaction_commit_dirty();
+	if (config->coalesce_pointer_motion) {
+		queue_pointer_motion(cursor, event->time_msec);
+	} else {
+		cursor_send_pointer_motion(cursor, event->time_msec, true);
+		transaction_commit_dirty();
+	}
+	dispatch_end(&motion_dispatch, start);
 }
 
 /**
@@ -765,10 +905,13 @@ void dispatch_cursor_button(struct sway_cursor *cursor,
 		time_msec = get_current_time_msec();
 	}
 	struct sway_seat *seat = cursor->seat;
+	flush_pointer_motion(cursor);
 
 	// Handle existing seat operation
 	if (cursor->seat->operation != OP_NONE) {
 		if (button == cursor->seat->op_button && state == WLR_BUTTON_RELEASED) {
+			// Make sure the final size reflects where the button was released
+			flush_resize_motion(cursor);
 			seat_end_mouse_operation(seat);
 			seat_pointer_notify_button(seat, time_msec, button, state);
 		}
@@ -938,17 +1081,20 @@ void dispatch_cursor_button(struct sway_cursor *cursor,
 }
 
 static void handle_cursor_button(struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, button);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_button *event = data;
 	dispatch_cursor_button(cursor,
 			event->time_msec, event->button, event->state);
 	transaction_commit_dirty();
+	dispatch_end(&button_dispatch, start);
 }
 
 static void dispatch_cursor_axis(struct sway_cursor *cursor,
 		struct wlr_event_pointer_axis *event) {
 	struct sway_seat *seat = cursor->seat;
+	flush_pointer_motion(cursor);
 
 	// Determine what's under the cursor
 	struct wlr_surface *surface = NULL;
@@ -1204,6 +1350,8 @@ void sway_cursor_destroy(struct sway_cursor *cursor) {
 		return;
 	}
 
+	wl_event_source_remove(cursor->resize_timer);
+	wl_event_source_remove(cursor->motion_timer);
 	wlr_xcursor_manager_destroy(cursor->xcursor_manager);
 	wlr_cursor_destroy(cursor->cursor);
 	free(cursor);
@@ -1221,6 +1369,22 @@ struct sway_cursor *sway_cursor_create(struct sway_seat *seat) {
 		return NULL;
 	}
 
+	cursor->resize_timer = wl_event_loop_add_timer(server.wl_event_loop,
+			handle_resize_timer, cursor);
+	if (!sway_assert(cursor->resize_timer, "could not create resize timer")) {
+		wlr_cursor_destroy(wlr_cursor);
+		free(cursor);
+		return NULL;
+	}
+	cursor->motion_timer = wl_event_loop_add_timer(server.wl_event_loop,
+			handle_motion_timer, cursor);
+	if (!sway_assert(cursor->motion_timer, "could not create motion timer")) {
+		wl_event_source_remove(cursor->resize_timer);
+		wlr_cursor_destroy(wlr_cursor);
+		free(cursor);
+		return NULL;
+	}
+
 	cursor->previous.x = wlr_cursor->x;
 	cursor->previous.y = wlr_cursor->y;
 
@@ -6,6 +6,7 @@
 #include <wlr/interfaces/wlr_keyboard.h>
 #include "sway/commands.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/keyboard.h"
 #include "sway/input/seat.h"
@@ -194,7 +195,11 @@ static size_t keyboard_keysyms_raw(struct sway_keyboard *keyboard,
 		keycode, layout_index, 0, keysyms);
 }
 
+static struct dispatch_stats key_dispatch = { .name = "keyboard key" };
+static struct dispatch_stats repeat_dispatch = { .name = "keyboard repeat" };
+
 static void handle_keyboard_key(struct wl_listener *listener, void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_keyboard *keyboard =
 		wl_container_of(listener, keyboard, keyboard_key);
 	struct sway_seat* seat = keyboard->seat_device->sway_seat;
@@ -315,9 +320,11 @@ static void handle_keyboard_key(struct wl_listener *listener, void *data) {
 	}
 
 	transaction_commit_dirty();
+	dispatch_end(&key_dispatch, start);
 }
 
 static int handle_keyboard_repeat(void *data) {
+	uint64_t start = dispatch_begin();
 	struct sway_keyboard *keyboard = (struct sway_keyboard *)data;
 	struct wlr_keyboard *wlr_device =
 			keyboard->seat_device->input_device->wlr_device->keyboard;
@@ -334,6 +341,7 @@ static int handle_keyboard_repeat(void *data) {
 				keyboard->repeat_binding);
 		transaction_commit_dirty();
 	}
+	dispatch_end(&repeat_dispatch, start);
 	return 0;
 }
 
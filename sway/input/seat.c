@@ -733,6 +733,11 @@ void seat_set_focus_warp(struct sway_seat *seat, struct sway_node *node,
 		}
 	}
 
+	// The new workspace may have missed layout changes while it was hidden
+	if (new_workspace && new_workspace->layout_stale) {
+		arrange_workspace(new_workspace);
+	}
+
 	// Close any popups on the old focus
 	if (last_focus && node_is_view(last_focus)) {
 		view_close_popups(last_focus->sway_container->view);
@@ -339,6 +339,25 @@ static void focus_inactive_children_iterator(struct sway_node *node,
 	json_object_array_add(focus, json_object_new_int(node->id));
 }
 
+/**
+ * A hidden workspace isn't arranged until it is shown, so its own geometry may
+ * be out of date. Its rect is rebuilt from the output's current usable area,
+ * but with the gaps from its last arrange, since smart gaps depend on focus
+ * and aren't worth re-evaluating from a query. The geometry of its containers
+ * and views is reported as last arranged, and is only refreshed once the
+ * workspace is shown again.
+ */
+static void get_stale_workspace_box(struct sway_workspace *workspace,
+		struct wlr_box *box) {
+	struct sway_output *output = workspace->output;
+	struct wlr_box *area = &output->usable_area;
+	double gaps = workspace->current_gaps;
+	box->x = output->wlr_output->lx + area->x + gaps;
+	box->y = output->wlr_output->ly + area->y + gaps;
+	box->width = area->width - 2 * gaps;
+	box->height = area->height - 2 * gaps;
+}
+
 json_object *ipc_json_describe_node(struct sway_node *node) {
 	struct sway_seat *seat = input_manager_get_default_seat(input_manager);
 	bool focused = seat_get_focus(seat) == node;
@@ -347,7 +366,12 @@ json_object *ipc_json_describe_node(struct sway_node *node) {
 	char *name = node_get_name(node);
 
 	struct wlr_box box;
-	node_get_box(node, &box);
+	if (node->type == N_WORKSPACE && node->sway_workspace->layout_stale &&
+			node->sway_workspace->output) {
+		get_stale_workspace_box(node->sway_workspace, &box);
+	} else {
+		node_get_box(node, &box);
+	}
 	json_object_object_add(object, "id", json_object_new_int((int)node->id));
 	json_object_object_add(object, "name",
 			name ? json_object_new_string(name) : NULL);
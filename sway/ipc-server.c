@@ -22,10 +22,12 @@
 #include "sway/commands.h"
 #include "sway/config.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/ipc-json.h"
 #include "sway/ipc-server.h"
 #include "sway/output.h"
 #include "sway/server.h"
+#include "sway/trace.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/tree/root.h"
@@ -48,6 +50,7 @@ struct ipc_client {
 	struct wl_event_source *writable_event_source;
 	struct sway_server *server;
 	int fd;
+	int index; // in ipc_client_list
 	uint32_t payload_length;
 	uint32_t security_policy;
 	enum ipc_command_type current_command;
@@ -55,8 +58,16 @@ struct ipc_client {
 	size_t write_buffer_len;
 	size_t write_buffer_size;
 	char *write_buffer;
+	char dispatch_name[32];
+	struct dispatch_stats dispatch;
 };
 
+static struct dispatch_stats accept_dispatch = { .name = "ipc accept" };
+static struct dispatch_stats read_dispatch = { .name = "ipc read" };
+static struct dispatch_stats write_dispatch = { .name = "ipc write" };
+// The client being dispatched to, cleared if it disconnects meanwhile
+static struct ipc_client *dispatch_client = NULL;
+
 struct sockaddr_un *ipc_user_sockaddr(void);
 int ipc_handle_connection(int fd, uint32_t mask, void *data);
 int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data);
@@ -149,7 +160,7 @@ struct sockaddr_un *ipc_user_sockaddr(void) {
 	return ipc_sockaddr;
 }
 
-int ipc_handle_connection(int fd, uint32_t mask, void *data) {
+static int handle_connection(int fd, uint32_t mask, void *data) {
 	(void) fd;
 	struct sway_server *server = data;
 	wlr_log(WLR_DEBUG, "Event on IPC listening socket");
@@ -188,6 +199,9 @@ int ipc_handle_connection(int fd, uint32_t mask, void *data) {
 	client->event_source = wl_event_loop_add_fd(server->wl_event_loop,
 			client_fd, WL_EVENT_READABLE, ipc_client_handle_readable, client);
 	client->writable_event_source = NULL;
+	snprintf(client->dispatch_name, sizeof(client->dispatch_name),
+			"ipc client %d", client_fd);
+	client->dispatch = (struct dispatch_stats){ .name = client->dispatch_name };
 
 	client->write_buffer_size = 128;
 	client->write_buffer_len = 0;
@@ -199,13 +213,40 @@ int ipc_handle_connection(int fd, uint32_t mask, void *data) {
 	}
 
 	wlr_log(WLR_DEBUG, "New client: fd %d", client_fd);
+	client->index = ipc_client_list->length;
 	list_add(ipc_client_list, client);
 	return 0;
 }
 
+int ipc_handle_connection(int fd, uint32_t mask, void *data) {
+	uint64_t start = dispatch_begin();
+	int ret = handle_connection(fd, mask, data);
+	dispatch_end(&accept_dispatch, start);
+	return ret;
+}
+
+/**
+ * Times a dispatch to a client against both the source type and the client
+ * itself. The handler may have disconnected and freed the client, in which
+ * case ipc_client_disconnect has cleared dispatch_client.
+ */
+static int client_dispatch(int (*handler)(int, uint32_t, void *),
+		struct dispatch_stats *stats, int client_fd, uint32_t mask,
+		struct ipc_client *client) {
+	uint64_t start = dispatch_begin();
+	dispatch_client = client;
+	int ret = handler(client_fd, mask, client);
+	if (dispatch_client == client) {
+		dispatch_end(&client->dispatch, start);
+	}
+	dispatch_client = NULL;
+	dispatch_end(stats, start);
+	return ret;
+}
+
 static const int ipc_header_size = sizeof(ipc_magic) + 8;
 
-int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data) {
+static int client_handle_readable(int client_fd, uint32_t mask, void *data) {
 	struct ipc_client *client = data;
 
 	if (mask & WL_EVENT_ERROR) {
@@ -267,6 +308,11 @@ int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data) {
 	return 0;
 }
 
+int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data) {
+	return client_dispatch(client_handle_readable, &read_dispatch,
+			client_fd, mask, data);
+}
+
 static bool ipc_has_event_listeners(enum ipc_command_type event) {
 	for (int i = 0; i < ipc_client_list->length; i++) {
 		struct ipc_client *client = ipc_client_list->items[i];
@@ -462,7 +508,7 @@ static void ipc_event_tick(const char *payload) {
 	json_object_put(json);
 }
 
-int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
+static int client_handle_writable(int client_fd, uint32_t mask, void *data) {
 	struct ipc_client *client = data;
 
 	if (mask & WL_EVENT_ERROR) {
@@ -504,6 +550,11 @@ int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
 	return 0;
 }
 
+int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
+	return client_dispatch(client_handle_writable, &write_dispatch,
+			client_fd, mask, data);
+}
+
 void ipc_client_disconnect(struct ipc_client *client) {
 	if (!sway_assert(client != NULL, "client != NULL")) {
 		return;
@@ -516,11 +567,16 @@ void ipc_client_disconnect(struct ipc_client *client) {
 	if (client->writable_event_source) {
 		wl_event_source_remove(client->writable_event_source);
 	}
-	int i = 0;
-	while (i < ipc_client_list->length && ipc_client_list->items[i] != client) {
-		i++;
+	// Swap the last client into this one's slot
+	list_del_unordered(ipc_client_list, client->index);
+	if (client->index < ipc_client_list->length) {
+		struct ipc_client *moved = ipc_client_list->items[client->index];
+		moved->index = client->index;
+	}
+	if (dispatch_client == client) {
+		dispatch_client = NULL;
 	}
-	list_del(ipc_client_list, i);
+	dispatch_stats_finish(&client->dispatch);
 	free(client->write_buffer);
 	close(client->fd);
 	free(client);
@@ -579,6 +635,9 @@ void ipc_client_handle_command(struct ipc_client *client) {
 	}
 	buf[client->payload_length] = '\0';
 
+	uint64_t trace_start = trace_begin();
+	enum ipc_command_type command_type = client->current_command;
+
 	bool client_valid = true;
 	switch (client->current_command) {
 	case IPC_COMMAND:
@@ -814,6 +873,11 @@ exit_cleanup:
 		client->payload_length = 0;
 	}
 	free(buf);
+	if (trace_start) {
+		char detail[16];
+		snprintf(detail, sizeof(detail), "type %d", command_type);
+		trace_end(trace_start, "ipc_request", detail);
+	}
 	return;
 }
 
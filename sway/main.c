@@ -17,8 +17,10 @@
 #include "sway/config.h"
 #include "sway/debug.h"
 #include "sway/desktop/transaction.h"
+#include "sway/dispatch.h"
 #include "sway/server.h"
 #include "sway/swaynag.h"
+#include "sway/trace.h"
 #include "sway/tree/root.h"
 #include "sway/ipc-server.h"
 #include "ipc-client.h"
@@ -210,6 +212,14 @@ void enable_debug_flag(const char *flag) {
 		debug.txn_timings = true;
 	} else if (strncmp(flag, "txn-timeout=", 12) == 0) {
 		server.txn_timeout_ms = atoi(&flag[12]);
+	} else if (strncmp(flag, "dispatch-threshold=", 19) == 0) {
+		debug.dispatch_threshold_ms = atoi(&flag[19]);
+	} else if (strcmp(flag, "trace") == 0) {
+		trace_enable();
+	} else if (strncmp(flag, "trace=", 6) == 0) {
+		free(debug.trace_path);
+		debug.trace_path = strdup(&flag[6]);
+		trace_enable();
 	}
 }
 
@@ -386,6 +396,8 @@ int main(int argc, char **argv) {
 
 	wlr_log(WLR_INFO, "Shutting down sway");
 
+	trace_finish();
+	dispatch_log_stats();
 	server_fini(&server);
 	root_destroy(root);
 	root = NULL;
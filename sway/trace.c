@@ -0,0 +1,131 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sway/debug.h"
+#include "sway/trace.h"
+#include "log.h"
+
+#define TRACE_CAPACITY 65536
+#define TRACE_DETAIL_SIZE 48
+
+struct trace_event {
+	const char *name;
+	uint64_t start, duration; // ns
+	char detail[TRACE_DETAIL_SIZE];
+};
+
+static struct trace_event *events = NULL;
+static size_t next_event = 0;
+static size_t event_count = 0;
+
+static uint64_t now_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void trace_enable(void) {
+	if (!events) {
+		events = calloc(TRACE_CAPACITY, sizeof(struct trace_event));
+		if (!events) {
+			wlr_log(WLR_ERROR, "Unable to allocate trace buffer");
+			return;
+		}
+	}
+	debug.trace = true;
+}
+
+void trace_disable(void) {
+	debug.trace = false;
+}
+
+bool trace_is_enabled(void) {
+	return debug.trace && events;
+}
+
+uint64_t trace_begin(void) {
+	if (!trace_is_enabled()) {
+		return 0;
+	}
+	return now_ns();
+}
+
+void trace_end(uint64_t start, const char *name, const char *detail) {
+	if (!start || !events) {
+		return;
+	}
+	struct trace_event *event = &events[next_event];
+	event->name = name;
+	event->start = start;
+	event->duration = now_ns() - start;
+	if (detail) {
+		strncpy(event->detail, detail, TRACE_DETAIL_SIZE - 1);
+		event->detail[TRACE_DETAIL_SIZE - 1] = '\0';
+	} else {
+		event->detail[0] = '\0';
+	}
+	next_event = (next_event + 1) % TRACE_CAPACITY;
+	if (event_count < TRACE_CAPACITY) {
+		++event_count;
+	}
+}
+
+static void write_escaped(FILE *file, const char *str) {
+	for (; *str; ++str) {
+		unsigned char c = *str;
+		if (c == '"' || c == '\\') {
+			fprintf(file, "\\%c", c);
+		} else if (c < 0x20) {
+			fprintf(file, "\\u%04x", c);
+		} else {
+			fputc(c, file);
+		}
+	}
+}
+
+bool trace_write(const char *path) {
+	FILE *file = fopen(path, "w");
+	if (!file) {
+		wlr_log_errno(WLR_ERROR, "Unable to open %s for writing", path);
+		return false;
+	}
+	pid_t pid = getpid();
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	size_t first = (next_event + TRACE_CAPACITY - event_count) % TRACE_CAPACITY;
+	for (size_t i = 0; i < event_count; ++i) {
+		struct trace_event *event = &events[(first + i) % TRACE_CAPACITY];
+		fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"sway\",\"ph\":\"X\","
+				"\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+				i ? "," : "", event->name, event->start / 1000.0,
+				event->duration / 1000.0, pid, pid);
+		if (event->detail[0]) {
+			fprintf(file, ",\"args\":{\"detail\":\"");
+			write_escaped(file, event->detail);
+			fprintf(file, "\"}");
+		}
+		fprintf(file, "}");
+	}
+	fprintf(file, "\n]}\n");
+	bool success = ferror(file) == 0;
+	if (fclose(file) != 0) {
+		success = false;
+	}
+	if (success) {
+		wlr_log(WLR_INFO, "Wrote %zu trace events to %s", event_count, path);
+	}
+	return success;
+}
+
+void trace_finish(void) {
+	if (events && debug.trace_path) {
+		trace_write(debug.trace_path);
+	}
+	free(events);
+	events = NULL;
+	next_event = event_count = 0;
+	free(debug.trace_path);
+	debug.trace_path = NULL;
+}
@@ -5,14 +5,97 @@
 #include <string.h>
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_output_layout.h>
+#include "sway/debug.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/container.h"
+#include "sway/tree/root.h"
 #include "sway/output.h"
+#include "sway/trace.h"
 #include "sway/tree/workspace.h"
 #include "sway/tree/view.h"
 #include "list.h"
 #include "log.h"
 
+static bool list_equal(list_t *a, list_t *b) {
+	if (!a || !b) {
+		return a == b;
+	}
+	if (a->length != b->length) {
+		return false;
+	}
+	return memcmp(a->items, b->items, a->length * sizeof(void *)) == 0;
+}
+
+static bool container_state_changed(struct sway_container *con) {
+	struct sway_container_state *state = &con->current;
+	if (con->layout != state->layout ||
+			con->x != state->con_x || con->y != state->con_y ||
+			con->width != state->con_width ||
+			con->height != state->con_height ||
+			con->is_fullscreen != state->is_fullscreen ||
+			con->parent != state->parent ||
+			con->workspace != state->workspace) {
+		return true;
+	}
+	if (con->view) {
+		struct sway_view *view = con->view;
+		return view->x != state->view_x || view->y != state->view_y ||
+			view->width != state->view_width ||
+			view->height != state->view_height ||
+			view->border != state->border ||
+			view->border_thickness != state->border_thickness ||
+			view->border_top != state->border_top ||
+			view->border_bottom != state->border_bottom ||
+			view->border_left != state->border_left ||
+			view->border_right != state->border_right;
+	}
+	return !list_equal(con->children, state->children);
+}
+
+static bool workspace_state_changed(struct sway_workspace *ws) {
+	struct sway_workspace_state *state = &ws->current;
+	return ws->x != state->x || ws->y != state->y ||
+		ws->width != state->width || ws->height != state->height ||
+		ws->layout != state->layout ||
+		ws->fullscreen != state->fullscreen ||
+		ws->output != state->output ||
+		!list_equal(ws->tiling, state->tiling) ||
+		!list_equal(ws->floating, state->floating);
+}
+
+/**
+ * Dirties a node that was just arranged, unless arranging it left it
+ * exactly as it was last committed. Focus is not compared: the seat dirties
+ * the nodes whose focus it changes.
+ *
+ * A node referenced by an unapplied transaction is always dirtied, because
+ * its current state is not what the next transaction would apply over.
+ */
+static void node_set_dirty_if_changed(struct sway_node *node) {
+	if (node->dirty) {
+		return;
+	}
+	if (node->ntxnrefs == 0) {
+		bool changed = true;
+		switch (node->type) {
+		case N_WORKSPACE:
+			changed = workspace_state_changed(node->sway_workspace);
+			break;
+		case N_CONTAINER:
+			changed = container_state_changed(node->sway_container);
+			break;
+		case N_ROOT:
+		case N_OUTPUT:
+			break;
+		}
+		if (!changed) {
+			debug_stats.arrange_skips++;
+			return;
+		}
+	}
+	node_set_dirty(node);
+}
+
 static void apply_horiz_layout(list_t *children, struct wlr_box *parent) {
 	if (!children->length) {
 		return;
@@ -167,19 +250,21 @@ void arrange_container(struct sway_container *container) {
 	}
 	if (container->view) {
 		view_autoconfigure(container->view);
-		node_set_dirty(&container->node);
+		node_set_dirty_if_changed(&container->node);
 		return;
 	}
 	struct wlr_box box;
 	container_get_box(container, &box);
 	arrange_children(container->children, container->layout, &box);
-	node_set_dirty(&container->node);
+	node_set_dirty_if_changed(&container->node);
 }
 
 void arrange_workspace(struct sway_workspace *workspace) {
 	if (config->reloading) {
 		return;
 	}
+	uint64_t trace_start = trace_begin();
+	workspace->layout_stale = false;
 	struct sway_output *output = workspace->output;
 	struct wlr_box *area = &output->usable_area;
 	wlr_log(WLR_DEBUG, "Usable area for ws: %dx%d@%d,%d",
@@ -212,7 +297,7 @@ void arrange_workspace(struct sway_workspace *workspace) {
 	}
 
 	workspace_add_gaps(workspace);
-	node_set_dirty(&workspace->node);
+	node_set_dirty_if_changed(&workspace->node);
 	wlr_log(WLR_DEBUG, "Arranging workspace '%s' at %f, %f", workspace->name,
 			workspace->x, workspace->y);
 	if (workspace->fullscreen) {
@@ -228,12 +313,14 @@ void arrange_workspace(struct sway_workspace *workspace) {
 		arrange_children(workspace->tiling, workspace->layout, &box);
 		arrange_floating(workspace->floating);
 	}
+	trace_end(trace_start, "arrange_workspace", workspace->name);
 }
 
 void arrange_output(struct sway_output *output) {
 	if (config->reloading) {
 		return;
 	}
+	uint64_t trace_start = trace_begin();
 	const struct wlr_box *output_box = wlr_output_layout_get_box(
 			root->output_layout, output->wlr_output);
 	output->lx = output_box->x;
@@ -241,16 +328,24 @@ void arrange_output(struct sway_output *output) {
 	output->width = output_box->width;
 	output->height = output_box->height;
 
+	// Hidden workspaces are arranged once they become visible, so that their
+	// clients don't repaint at sizes nobody sees
 	for (int i = 0; i < output->workspaces->length; ++i) {
 		struct sway_workspace *workspace = output->workspaces->items[i];
-		arrange_workspace(workspace);
+		if (workspace_is_visible(workspace)) {
+			arrange_workspace(workspace);
+		} else {
+			workspace->layout_stale = true;
+		}
 	}
+	trace_end(trace_start, "arrange_output", output->wlr_output->name);
 }
 
 void arrange_root(void) {
 	if (config->reloading) {
 		return;
 	}
+	uint64_t trace_start = trace_begin();
 	const struct wlr_box *layout_box =
 		wlr_output_layout_get_box(root->output_layout, NULL);
 	root->x = layout_box->x;
@@ -261,6 +356,7 @@ void arrange_root(void) {
 		struct sway_output *output = root->outputs->items[i];
 		arrange_output(output);
 	}
+	trace_end(trace_start, "arrange_root", NULL);
 }
 
 void arrange_node(struct sway_node *node) {
@@ -18,6 +18,7 @@
 #include "sway/ipc-server.h"
 #include "sway/output.h"
 #include "sway/server.h"
+#include "sway/trace.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
@@ -484,6 +485,7 @@ static void update_title_texture(struct sway_container *con,
 }
 
 void container_update_title_textures(struct sway_container *container) {
+	uint64_t trace_start = trace_begin();
 	update_title_texture(container, &container->title_focused,
 			&config->border_colors.focused);
 	update_title_texture(container, &container->title_focused_inactive,
@@ -493,6 +495,7 @@ void container_update_title_textures(struct sway_container *container) {
 	update_title_texture(container, &container->title_urgent,
 			&config->border_colors.urgent);
 	container_damage_whole(container);
+	trace_end(trace_start, "title_textures", container->formatted_title);
 }
 
 void container_calculate_title_height(struct sway_container *container) {
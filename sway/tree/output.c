@@ -56,6 +56,7 @@ struct sway_output *output_create(struct wlr_output *wlr_output) {
 
 	output->workspaces = create_list();
 	output->current.workspaces = create_list();
+	output->visible_views = create_list();
 
 	return output;
 }
@@ -185,6 +186,9 @@ void output_destroy(struct sway_output *output) {
 	}
 	list_free(output->workspaces);
 	list_free(output->current.workspaces);
+	list_free(output->visible_views);
+	free(output->bg_args);
+	output_terminate_swaybg(output);
 	free(output);
 }
 
@@ -217,6 +221,11 @@ void output_disable(struct sway_output *output) {
 	wl_list_remove(&output->damage_frame.link);
 
 	output->enabled = false;
+	output->visible_views->length = 0;
+	free(output->bg_args);
+	output->bg_args = NULL;
+	output_terminate_swaybg(output);
+	update_swaybg();
 
 	arrange_root();
 }
@@ -21,6 +21,7 @@
 #include "sway/ipc-server.h"
 #include "sway/output.h"
 #include "sway/input/seat.h"
+#include "sway/trace.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/container.h"
 #include "sway/tree/view.h"
@@ -1044,6 +1045,7 @@ void view_update_marks_textures(struct sway_view *view) {
 	if (!config->show_marks) {
 		return;
 	}
+	uint64_t trace_start = trace_begin();
 	update_marks_texture(view, &view->marks_focused,
 			&config->border_colors.focused);
 	update_marks_texture(view, &view->marks_focused_inactive,
@@ -1053,6 +1055,7 @@ void view_update_marks_textures(struct sway_view *view) {
 	update_marks_texture(view, &view->marks_urgent,
 			&config->border_colors.urgent);
 	container_damage_whole(view->container);
+	trace_end(trace_start, "marks_textures", NULL);
 }
 
 bool view_is_visible(struct sway_view *view) {
@@ -18,7 +18,6 @@
 #endif
 #include "swaybar/bar.h"
 #include "swaybar/config.h"
-#include "swaybar/event_loop.h"
 #include "swaybar/i3bar.h"
 #include "swaybar/ipc.h"
 #include "swaybar/status_line.h"
@@ -30,17 +29,23 @@
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 #include "xdg-output-unstable-v1-client-protocol.h"
 
+void sway_terminate(int code);
+
 static void bar_init(struct swaybar *bar) {
 	bar->config = init_config();
 	wl_list_init(&bar->outputs);
 }
 
+void free_workspace(struct swaybar_workspace *ws) {
+	wl_list_remove(&ws->link);
+	free(ws->name);
+	free(ws);
+}
+
 void free_workspaces(struct wl_list *list) {
 	struct swaybar_workspace *ws, *tmp;
 	wl_list_for_each_safe(ws, tmp, list, link) {
-		wl_list_remove(&ws->link);
-		free(ws->name);
-		free(ws);
+		free_workspace(ws);
 	}
 }
 
@@ -57,9 +62,11 @@ static void swaybar_output_free(struct swaybar_output *output) {
 	}
 	zxdg_output_v1_destroy(output->xdg_output);
 	wl_output_destroy(output->output);
-	destroy_buffer(&output->buffers[0]);
-	destroy_buffer(&output->buffers[1]);
+	for (size_t i = 0; i < POOL_BUFFER_COUNT; ++i) {
+		destroy_buffer(&output->buffers[i]);
+	}
 	free_workspaces(&output->workspaces);
+	render_free_cache(output);
 	struct swaybar_hotspot *hotspot, *hotspot_tmp;
 	wl_list_for_each_safe(hotspot, hotspot_tmp, &output->hotspots, link) {
 		if (hotspot->destroy) {
@@ -72,7 +79,7 @@ static void swaybar_output_free(struct swaybar_output *output) {
 	free(output);
 }
 
-static void set_output_dirty(struct swaybar_output *output) {
+void set_output_dirty(struct swaybar_output *output) {
 	if (output->frame_scheduled) {
 		output->dirty = true;
 		return;
@@ -480,6 +487,8 @@ static void handle_global(void *data, struct wl_registry *registry,
 		output->wl_name = name;
 		wl_list_init(&output->workspaces);
 		wl_list_init(&output->hotspots);
+		wl_list_init(&output->render_cache);
+		wl_array_init(&output->last_frame.items);
 		wl_list_init(&output->link);
 		if (bar->xdg_output_manager != NULL) {
 			add_xdg_output(output);
@@ -510,17 +519,17 @@ static const struct wl_registry_listener registry_listener = {
 	.global_remove = handle_global_remove,
 };
 
-static void set_bar_dirty(struct swaybar *bar) {
+void set_bar_dirty(struct swaybar *bar) {
 	struct swaybar_output *output;
 	wl_list_for_each(output, &bar->outputs, link) {
 		set_output_dirty(output);
 	}
 }
 
-bool bar_setup(struct swaybar *bar,
+bool bar_setup(struct swaybar *bar, struct loop *eventloop,
 		const char *socket_path, const char *bar_id) {
 	bar_init(bar);
-	init_event_loop();
+	bar->eventloop = eventloop;
 
 	bar->ipc_socketfd = ipc_open_socket(socket_path);
 	bar->ipc_event_socketfd = ipc_open_socket(socket_path);
@@ -528,7 +537,7 @@ bool bar_setup(struct swaybar *bar,
 		return false;
 	}
 	if (bar->config->status_command) {
-		bar->status = status_line_init(bar->config->status_command);
+		bar->status = status_line_init(bar, bar->config->status_command);
 	}
 
 	bar->display = wl_display_connect(NULL);
@@ -566,15 +575,13 @@ bool bar_setup(struct swaybar *bar,
 	assert(pointer->cursor_surface);
 
 	ipc_get_workspaces(bar);
-	set_bar_dirty(bar);
 	return true;
 }
 
 static void display_in(int fd, short mask, void *data) {
 	struct swaybar *bar = data;
 	if (wl_display_dispatch(bar->display) == -1) {
-		bar_teardown(bar);
-		exit(0);
+		sway_terminate(0);
 	}
 }
 
@@ -585,27 +592,10 @@ static void ipc_in(int fd, short mask, void *data) {
 	}
 }
 
-static void status_in(int fd, short mask, void *data) {
-	struct swaybar *bar = data;
-	if (mask & (POLLHUP | POLLERR)) {
-		status_error(bar->status, "[error reading from status command]");
-		set_bar_dirty(bar);
-		remove_event(fd);
-	} else if (status_handle_readable(bar->status)) {
-		set_bar_dirty(bar);
-	}
-}
-
 void bar_run(struct swaybar *bar) {
-	add_event(wl_display_get_fd(bar->display), POLLIN, display_in, bar);
-	add_event(bar->ipc_event_socketfd, POLLIN, ipc_in, bar);
-	if (bar->status) {
-		add_event(bar->status->read_fd, POLLIN, status_in, bar);
-	}
-	while (1) {
-		wl_display_flush(bar->display);
-		event_loop_poll();
-	}
+	loop_add_fd(bar->eventloop, wl_display_get_fd(bar->display), POLLIN,
+			display_in, bar);
+	loop_add_fd(bar->eventloop, bar->ipc_event_socketfd, POLLIN, ipc_in, bar);
 }
 
 static void free_outputs(struct wl_list *list) {
@@ -623,6 +613,6 @@ void bar_teardown(struct swaybar *bar) {
 	close(bar->ipc_event_socketfd);
 	close(bar->ipc_socketfd);
 	if (bar->status) {
-		status_line_free(bar->status);
+		status_line_release(bar->status, bar);
 	}
 }
@@ -27,87 +27,195 @@ void i3bar_block_unref(struct i3bar_block *block) {
 	}
 }
 
-static void i3bar_parse_json(struct status_line *status,
-		struct json_object *json_array) {
-	struct i3bar_block *block, *tmp;
-	wl_list_for_each_safe(block, tmp, &status->blocks, link) {
-		wl_list_remove(&block->link);
-		i3bar_block_unref(block);
+static uint32_t hash_string(uint32_t hash, const char *str) {
+	// FNV-1a
+	if (str) {
+		for (; *str; ++str) {
+			hash = (hash ^ (uint8_t)*str) * 16777619u;
+		}
 	}
+	return (hash ^ 0xff) * 16777619u;
+}
+
+static uint32_t hash_int(uint32_t hash, uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		hash = (hash ^ ((value >> (i * 8)) & 0xff)) * 16777619u;
+	}
+	return hash;
+}
+
+static uint32_t i3bar_block_hash(struct i3bar_block *block) {
+	uint32_t hash = 2166136261u;
+	hash = hash_string(hash, block->full_text);
+	hash = hash_string(hash, block->short_text);
+	hash = hash_string(hash, block->align);
+	hash = hash_string(hash, block->name);
+	hash = hash_string(hash, block->instance);
+	hash = hash_int(hash, block->color ? *block->color : 0);
+	hash = hash_int(hash, block->color != NULL);
+	hash = hash_int(hash, block->urgent);
+	hash = hash_int(hash, block->min_width);
+	hash = hash_int(hash, block->separator);
+	hash = hash_int(hash, block->separator_block_width);
+	hash = hash_int(hash, block->markup);
+	hash = hash_int(hash, block->background);
+	hash = hash_int(hash, block->border);
+	hash = hash_int(hash, block->border_top);
+	hash = hash_int(hash, block->border_bottom);
+	hash = hash_int(hash, block->border_left);
+	hash = hash_int(hash, block->border_right);
+	return hash;
+}
+
+static bool string_equal(const char *a, const char *b) {
+	return a == b || (a && b && strcmp(a, b) == 0);
+}
+
+static bool i3bar_block_equal(struct i3bar_block *a, struct i3bar_block *b) {
+	return a->hash == b->hash
+		&& string_equal(a->name, b->name)
+		&& string_equal(a->instance, b->instance)
+		&& string_equal(a->full_text, b->full_text)
+		&& string_equal(a->short_text, b->short_text)
+		&& string_equal(a->align, b->align)
+		&& (a->color == NULL) == (b->color == NULL)
+		&& (!a->color || *a->color == *b->color)
+		&& a->urgent == b->urgent
+		&& a->min_width == b->min_width
+		&& a->separator == b->separator
+		&& a->separator_block_width == b->separator_block_width
+		&& a->markup == b->markup
+		&& a->background == b->background
+		&& a->border == b->border
+		&& a->border_top == b->border_top
+		&& a->border_bottom == b->border_bottom
+		&& a->border_left == b->border_left
+		&& a->border_right == b->border_right;
+}
+
+static struct i3bar_block *i3bar_parse_block(json_object *json) {
+	json_object *full_text, *short_text, *color, *min_width, *align, *urgent;
+	json_object *name, *instance, *separator, *separator_block_width;
+	json_object *background, *border, *border_top, *border_bottom;
+	json_object *border_left, *border_right, *markup;
+	json_object_object_get_ex(json, "full_text", &full_text);
+	json_object_object_get_ex(json, "short_text", &short_text);
+	json_object_object_get_ex(json, "color", &color);
+	json_object_object_get_ex(json, "min_width", &min_width);
+	json_object_object_get_ex(json, "align", &align);
+	json_object_object_get_ex(json, "urgent", &urgent);
+	json_object_object_get_ex(json, "name", &name);
+	json_object_object_get_ex(json, "instance", &instance);
+	json_object_object_get_ex(json, "markup", &markup);
+	json_object_object_get_ex(json, "separator", &separator);
+	json_object_object_get_ex(json, "separator_block_width", &separator_block_width);
+	json_object_object_get_ex(json, "background", &background);
+	json_object_object_get_ex(json, "border", &border);
+	json_object_object_get_ex(json, "border_top", &border_top);
+	json_object_object_get_ex(json, "border_bottom", &border_bottom);
+	json_object_object_get_ex(json, "border_left", &border_left);
+	json_object_object_get_ex(json, "border_right", &border_right);
+
+	struct i3bar_block *block = calloc(1, sizeof(struct i3bar_block));
+	if (!block) {
+		return NULL;
+	}
+	block->ref_count = 1;
+	block->full_text = full_text ?
+		strdup(json_object_get_string(full_text)) : NULL;
+	block->short_text = short_text ?
+		strdup(json_object_get_string(short_text)) : NULL;
+	if (color) {
+		block->color = malloc(sizeof(uint32_t));
+		*block->color = parse_color(json_object_get_string(color));
+	}
+	if (min_width) {
+		json_type type = json_object_get_type(min_width);
+		if (type == json_type_int) {
+			block->min_width = json_object_get_int(min_width);
+		} else if (type == json_type_string) {
+			/* the width will be calculated when rendering */
+			block->min_width = 0;
+		}
+	}
+	block->align = strdup(align ? json_object_get_string(align) : "left");
+	block->urgent = urgent ? json_object_get_int(urgent) : false;
+	block->name = name ? strdup(json_object_get_string(name)) : NULL;
+	block->instance = instance ?
+		strdup(json_object_get_string(instance)) : NULL;
+	if (markup) {
+		block->markup = false;
+		const char *markup_str = json_object_get_string(markup);
+		if (strcmp(markup_str, "pango") == 0) {
+			block->markup = true;
+		}
+	}
+	block->separator = separator ? json_object_get_int(separator) : true;
+	block->separator_block_width = separator_block_width ?
+		json_object_get_int(separator_block_width) : 9;
+	// Airblader features
+	block->background = background ?
+		parse_color(json_object_get_string(background)) : 0;
+	block->border = border ? 
+		parse_color(json_object_get_string(border)) : 0;
+	block->border_top = border_top ? json_object_get_int(border_top) : 1;
+	block->border_bottom = border_bottom ?
+		json_object_get_int(border_bottom) : 1;
+	block->border_left = border_left ? json_object_get_int(border_left) : 1;
+	block->border_right = border_right ?
+		json_object_get_int(border_right) : 1;
+	block->hash = i3bar_block_hash(block);
+	return block;
+}
+
+/**
+ * Replaces the status blocks with the ones in json_array. Blocks which are
+ * the same as the one in the same position of the previous update are kept,
+ * so their hotspots and cached renderings stay valid. Returns true if
+ * anything changed.
+ */
+static bool i3bar_parse_json(struct status_line *status,
+		struct json_object *json_array) {
+	struct wl_list blocks;
+	wl_list_init(&blocks);
 	for (size_t i = 0; i < json_object_array_length(json_array); ++i) {
-		json_object *full_text, *short_text, *color, *min_width, *align, *urgent;
-		json_object *name, *instance, *separator, *separator_block_width;
-		json_object *background, *border, *border_top, *border_bottom;
-		json_object *border_left, *border_right, *markup;
 		json_object *json = json_object_array_get_idx(json_array, i);
 		if (!json) {
 			continue;
 		}
-		json_object_object_get_ex(json, "full_text", &full_text);
-		json_object_object_get_ex(json, "short_text", &short_text);
-		json_object_object_get_ex(json, "color", &color);
-		json_object_object_get_ex(json, "min_width", &min_width);
-		json_object_object_get_ex(json, "align", &align);
-		json_object_object_get_ex(json, "urgent", &urgent);
-		json_object_object_get_ex(json, "name", &name);
-		json_object_object_get_ex(json, "instance", &instance);
-		json_object_object_get_ex(json, "markup", &markup);
-		json_object_object_get_ex(json, "separator", &separator);
-		json_object_object_get_ex(json, "separator_block_width", &separator_block_width);
-		json_object_object_get_ex(json, "background", &background);
-		json_object_object_get_ex(json, "border", &border);
-		json_object_object_get_ex(json, "border_top", &border_top);
-		json_object_object_get_ex(json, "border_bottom", &border_bottom);
-		json_object_object_get_ex(json, "border_left", &border_left);
-		json_object_object_get_ex(json, "border_right", &border_right);
-
-		struct i3bar_block *block = calloc(1, sizeof(struct i3bar_block));
-		block->ref_count = 1;
-		block->full_text = full_text ?
-			strdup(json_object_get_string(full_text)) : NULL;
-		block->short_text = short_text ?
-			strdup(json_object_get_string(short_text)) : NULL;
-		if (color) {
-			block->color = malloc(sizeof(uint32_t));
-			*block->color = parse_color(json_object_get_string(color));
+		struct i3bar_block *block = i3bar_parse_block(json);
+		if (block) {
+			wl_list_insert(&blocks, &block->link);
 		}
-		if (min_width) {
-			json_type type = json_object_get_type(min_width);
-			if (type == json_type_int) {
-				block->min_width = json_object_get_int(min_width);
-			} else if (type == json_type_string) {
-				/* the width will be calculated when rendering */
-				block->min_width = 0;
-			}
+	}
+
+	// Both lists are in reverse order, so compare them from the tail
+	bool changed = wl_list_length(&blocks) != wl_list_length(&status->blocks);
+	struct wl_list *old_link = status->blocks.prev;
+	struct i3bar_block *block, *tmp;
+	wl_list_for_each_reverse_safe(block, tmp, &blocks, link) {
+		if (old_link == &status->blocks) {
+			break;
 		}
-		block->align = strdup(align ? json_object_get_string(align) : "left");
-		block->urgent = urgent ? json_object_get_int(urgent) : false;
-		block->name = name ? strdup(json_object_get_string(name)) : NULL;
-		block->instance = instance ?
-			strdup(json_object_get_string(instance)) : NULL;
-		if (markup) {
-			block->markup = false;
-			const char *markup_str = json_object_get_string(markup);
-			if (strcmp(markup_str, "pango") == 0) {
-				block->markup = true;
-			}
+		struct i3bar_block *old = wl_container_of(old_link, old, link);
+		old_link = old_link->prev;
+		if (i3bar_block_equal(old, block)) {
+			// Keep the old block in place of the new one
+			wl_list_remove(&old->link);
+			wl_list_insert(&block->link, &old->link);
+			wl_list_remove(&block->link);
+			i3bar_block_unref(block);
+		} else {
+			changed = true;
 		}
-		block->separator = separator ? json_object_get_int(separator) : true;
-		block->separator_block_width = separator_block_width ?
-			json_object_get_int(separator_block_width) : 9;
-		// Airblader features
-		block->background = background ?
-			parse_color(json_object_get_string(background)) : 0;
-		block->border = border ? 
-			parse_color(json_object_get_string(border)) : 0;
-		block->border_top = border_top ? json_object_get_int(border_top) : 1;
-		block->border_bottom = border_bottom ?
-			json_object_get_int(border_bottom) : 1;
-		block->border_left = border_left ? json_object_get_int(border_left) : 1;
-		block->border_right = border_right ?
-			json_object_get_int(border_right) : 1;
-		wl_list_insert(&status->blocks, &block->link);
 	}
+
+	wl_list_for_each_safe(block, tmp, &status->blocks, link) {
+		wl_list_remove(&block->link);
+		i3bar_block_unref(block);
+	}
+	wl_list_insert_list(&status->blocks, &blocks);
+	return changed;
 }
 
 bool i3bar_handle_readable(struct status_line *status) {
@@ -249,10 +357,12 @@ bool i3bar_handle_readable(struct status_line *status) {
 	}
 
 	if (last_object) {
-		wlr_log(WLR_DEBUG, "Rendering last received json");
-		i3bar_parse_json(status, last_object);
+		bool changed = i3bar_parse_json(status, last_object);
 		json_object_put(last_object);
-		return true;
+		if (changed) {
+			wlr_log(WLR_DEBUG, "Rendering last received json");
+		}
+		return changed;
 	} else {
 		return false;
 	}
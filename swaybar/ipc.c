@@ -254,6 +254,25 @@ static bool ipc_parse_config(
 	return true;
 }
 
+static struct swaybar_workspace *ipc_parse_workspace(json_object *ws_json) {
+	json_object *id, *num, *name, *visible, *focused, *urgent;
+	json_object_object_get_ex(ws_json, "id", &id);
+	json_object_object_get_ex(ws_json, "num", &num);
+	json_object_object_get_ex(ws_json, "name", &name);
+	json_object_object_get_ex(ws_json, "visible", &visible);
+	json_object_object_get_ex(ws_json, "focused", &focused);
+	json_object_object_get_ex(ws_json, "urgent", &urgent);
+
+	struct swaybar_workspace *ws = calloc(1, sizeof(struct swaybar_workspace));
+	ws->id = json_object_get_int(id);
+	ws->num = json_object_get_int(num);
+	ws->name = strdup(json_object_get_string(name));
+	ws->visible = json_object_get_boolean(visible);
+	ws->focused = json_object_get_boolean(focused);
+	ws->urgent = json_object_get_boolean(urgent);
+	return ws;
+}
+
 void ipc_get_workspaces(struct swaybar *bar) {
 	struct swaybar_output *output;
 	wl_list_for_each(output, &bar->outputs, link) {
@@ -266,40 +285,201 @@ void ipc_get_workspaces(struct swaybar *bar) {
 	json_object *results = json_tokener_parse(res);
 	if (!results) {
 		free(res);
+		set_bar_dirty(bar);
 		return;
 	}
 	size_t length = json_object_array_length(results);
-	json_object *ws_json;
-	json_object *num, *name, *visible, *focused, *out, *urgent;
+	json_object *ws_json, *out;
 	for (size_t i = 0; i < length; ++i) {
 		ws_json = json_object_array_get_idx(results, i);
-
-		json_object_object_get_ex(ws_json, "num", &num);
-		json_object_object_get_ex(ws_json, "name", &name);
-		json_object_object_get_ex(ws_json, "visible", &visible);
-		json_object_object_get_ex(ws_json, "focused", &focused);
 		json_object_object_get_ex(ws_json, "output", &out);
-		json_object_object_get_ex(ws_json, "urgent", &urgent);
 
 		wl_list_for_each(output, &bar->outputs, link) {
 			const char *ws_output = json_object_get_string(out);
 			if (strcmp(ws_output, output->name) == 0) {
-				struct swaybar_workspace *ws =
-					calloc(1, sizeof(struct swaybar_workspace));
-				ws->num = json_object_get_int(num);
-				ws->name = strdup(json_object_get_string(name));
-				ws->visible = json_object_get_boolean(visible);
-				ws->focused = json_object_get_boolean(focused);
+				struct swaybar_workspace *ws = ipc_parse_workspace(ws_json);
 				if (ws->focused) {
 					output->focused = true;
 				}
-				ws->urgent = json_object_get_boolean(urgent);
 				wl_list_insert(&output->workspaces, &ws->link);
 			}
 		}
 	}
 	json_object_put(results);
 	free(res);
+	// Only now that the new lists are built, as this may render right away
+	set_bar_dirty(bar);
+}
+
+static struct swaybar_output *find_output(struct swaybar *bar,
+		const char *name) {
+	if (!name) {
+		return NULL;
+	}
+	struct swaybar_output *output;
+	wl_list_for_each(output, &bar->outputs, link) {
+		if (output->name && strcmp(output->name, name) == 0) {
+			return output;
+		}
+	}
+	return NULL;
+}
+
+static struct swaybar_workspace *find_workspace(struct swaybar *bar, int id,
+		struct swaybar_output **ws_output) {
+	struct swaybar_output *output;
+	wl_list_for_each(output, &bar->outputs, link) {
+		struct swaybar_workspace *ws;
+		wl_list_for_each(ws, &output->workspaces, link) {
+			if (ws->id == id) {
+				*ws_output = output;
+				return ws;
+			}
+		}
+	}
+	*ws_output = NULL;
+	return NULL;
+}
+
+// Mirrors the order sway keeps each output's workspaces in
+static int workspace_cmp(struct swaybar_workspace *a,
+		struct swaybar_workspace *b) {
+	if (a->num >= 0 && b->num >= 0) {
+		return (a->num < b->num) ? -1 : (a->num > b->num);
+	} else if (a->num >= 0) {
+		return -1;
+	} else if (b->num >= 0) {
+		return 1;
+	}
+	return 0;
+}
+
+static void insert_workspace(struct swaybar_output *output,
+		struct swaybar_workspace *ws) {
+	// The list is stored in reverse, as the renderer walks it backwards
+	struct swaybar_workspace *iter;
+	wl_list_for_each_reverse(iter, &output->workspaces, link) {
+		if (workspace_cmp(ws, iter) < 0) {
+			wl_list_insert(&iter->link, &ws->link);
+			return;
+		}
+	}
+	wl_list_insert(&output->workspaces, &ws->link);
+}
+
+static void handle_workspace_focus(struct swaybar *bar,
+		struct swaybar_output *focused_output, int id) {
+	struct swaybar_output *output;
+	wl_list_for_each(output, &bar->outputs, link) {
+		bool dirty = false;
+		output->focused = false;
+		struct swaybar_workspace *ws;
+		wl_list_for_each(ws, &output->workspaces, link) {
+			bool focused = ws->id == id;
+			if (ws->focused != focused) {
+				ws->focused = focused;
+				dirty = true;
+			}
+			if (output == focused_output && ws->visible != focused) {
+				ws->visible = focused;
+				dirty = true;
+			}
+			output->focused |= focused;
+		}
+		if (dirty) {
+			set_output_dirty(output);
+		}
+	}
+}
+
+/**
+ * Apply a workspace event to the workspaces we already know about, marking
+ * only the affected outputs as dirty. Returns false if the event can't be
+ * applied on its own and the full workspace list needs to be fetched.
+ */
+static bool handle_workspace_event(struct swaybar *bar, json_object *event) {
+	json_object *json_change, *current, *json_id, *json_output;
+	if (!json_object_object_get_ex(event, "change", &json_change) ||
+			!json_object_object_get_ex(event, "current", &current) ||
+			!current ||
+			!json_object_object_get_ex(current, "id", &json_id)) {
+		return false;
+	}
+	const char *change = json_object_get_string(json_change);
+	int id = json_object_get_int(json_id);
+	json_object_object_get_ex(current, "output", &json_output);
+	struct swaybar_output *output =
+		find_output(bar, json_object_get_string(json_output));
+	struct swaybar_output *ws_output;
+	struct swaybar_workspace *ws = find_workspace(bar, id, &ws_output);
+
+	if (strcmp(change, "init") == 0) {
+		if (ws) {
+			return false;
+		}
+		if (output) {
+			ws = ipc_parse_workspace(current);
+			ws->focused = false;
+			ws->visible = wl_list_empty(&output->workspaces);
+			insert_workspace(output, ws);
+			set_output_dirty(output);
+		}
+	} else if (strcmp(change, "empty") == 0) {
+		if (!ws) {
+			return output == NULL;
+		}
+		if (ws->visible || ws->focused) {
+			return false;
+		}
+		free_workspace(ws);
+		set_output_dirty(ws_output);
+	} else if (strcmp(change, "focus") == 0) {
+		if (!ws && output) {
+			return false;
+		}
+		handle_workspace_focus(bar, output, id);
+	} else if (strcmp(change, "rename") == 0) {
+		if (!ws) {
+			return output == NULL;
+		}
+		json_object *name, *num;
+		json_object_object_get_ex(current, "name", &name);
+		json_object_object_get_ex(current, "num", &num);
+		free(ws->name);
+		ws->name = strdup(json_object_get_string(name));
+		ws->num = json_object_get_int(num);
+		wl_list_remove(&ws->link);
+		insert_workspace(ws_output, ws);
+		set_output_dirty(ws_output);
+	} else if (strcmp(change, "urgent") == 0) {
+		if (!ws) {
+			return output == NULL;
+		}
+		json_object *urgent;
+		json_object_object_get_ex(current, "urgent", &urgent);
+		ws->urgent = json_object_get_boolean(urgent);
+		set_output_dirty(ws_output);
+	} else if (strcmp(change, "move") == 0) {
+		if (ws) {
+			if (ws->visible || ws->focused) {
+				// Another workspace becomes visible on the old output
+				return false;
+			}
+			free_workspace(ws);
+			set_output_dirty(ws_output);
+		}
+		if (output) {
+			ws = ipc_parse_workspace(current);
+			ws->focused = false;
+			ws->visible = wl_list_empty(&output->workspaces);
+			insert_workspace(output, ws);
+			set_output_dirty(output);
+		}
+	} else {
+		// "reload" and anything we don't understand
+		return false;
+	}
+	return true;
 }
 
 static void ipc_get_outputs(struct swaybar *bar) {
@@ -369,9 +549,16 @@ bool handle_ipc_readable(struct swaybar *bar) {
 		return false;
 	}
 	switch (resp->type) {
-	case IPC_EVENT_WORKSPACE:
-		ipc_get_workspaces(bar);
-		break;
+	case IPC_EVENT_WORKSPACE: {
+		// Workspace changes only dirty the outputs they affect
+		json_object *result = json_tokener_parse(resp->payload);
+		if (!result || !handle_workspace_event(bar, result)) {
+			ipc_get_workspaces(bar);
+		}
+		json_object_put(result);
+		free_ipc_response(resp);
+		return false;
+	}
 	case IPC_EVENT_MODE: {
 		json_object *result = json_tokener_parse(resp->payload);
 		if (!result) {
@@ -7,22 +7,42 @@
 #include <wlr/util/log.h>
 #include "swaybar/bar.h"
 #include "ipc-client.h"
+#include "list.h"
+#include "loop.h"
+#include "stringop.h"
 
-static struct swaybar swaybar;
+static list_t *bars; // struct swaybar
+static struct loop *eventloop;
+
+static void teardown(void) {
+	if (bars) {
+		for (int i = 0; i < bars->length; ++i) {
+			struct swaybar *bar = bars->items[i];
+			bar_teardown(bar);
+			free(bar);
+		}
+		list_free(bars);
+		bars = NULL;
+	}
+	if (eventloop) {
+		loop_destroy(eventloop);
+		eventloop = NULL;
+	}
+}
 
 void sig_handler(int signal) {
-	bar_teardown(&swaybar);
+	teardown();
 	exit(0);
 }
 
 void sway_terminate(int code) {
-	bar_teardown(&swaybar);
+	teardown();
 	exit(code);
 }
 
 int main(int argc, char **argv) {
 	char *socket_path = NULL;
-	char *bar_id = NULL;
+	list_t *bar_ids = create_list();
 	bool debug = false;
 
 	static struct option long_options[] = {
@@ -41,6 +61,8 @@ int main(int argc, char **argv) {
 		"  -v, --version          Show the version number and quit.\n"
 		"  -s, --socket <socket>  Connect to sway via socket.\n"
 		"  -b, --bar_id <id>      Bar ID for which to get the configuration.\n"
+		"                         May be repeated to run several bars in one\n"
+		"                         process, sharing identical status commands.\n"
 		"  -d, --debug            Enable debugging.\n"
 		"\n"
 		" PLEASE NOTE that swaybar will be automatically started by sway as\n"
@@ -59,7 +81,7 @@ int main(int argc, char **argv) {
 			socket_path = strdup(optarg);
 			break;
 		case 'b': // Type
-			bar_id = strdup(optarg);
+			list_add(bar_ids, strdup(optarg));
 			break;
 		case 'v':
 			fprintf(stdout, "swaybar version " SWAY_VERSION "\n");
@@ -80,7 +102,7 @@ int main(int argc, char **argv) {
 		wlr_log_init(WLR_ERROR, NULL);
 	}
 
-	if (!bar_id) {
+	if (bar_ids->length == 0) {
 		wlr_log(WLR_ERROR, "No bar_id passed. "
 				"Provide --bar_id or let sway start swaybar");
 		return 1;
@@ -96,15 +118,42 @@ int main(int argc, char **argv) {
 
 	signal(SIGTERM, sig_handler);
 
-	if (!bar_setup(&swaybar, socket_path, bar_id)) {
-		free(socket_path);
+	eventloop = loop_create();
+	if (!eventloop) {
 		return 1;
 	}
+	bars = create_list();
+	bool success = true;
+	for (int i = 0; success && i < bar_ids->length; ++i) {
+		struct swaybar *bar = calloc(1, sizeof(struct swaybar));
+		if (!bar) {
+			wlr_log(WLR_ERROR, "Unable to allocate memory for bar");
+			success = false;
+			break;
+		}
+		list_add(bars, bar);
+		success = bar_setup(bar, eventloop, socket_path, bar_ids->items[i]);
+	}
 
 	free(socket_path);
-	free(bar_id);
+	free_flat_list(bar_ids);
+
+	if (!success) {
+		teardown();
+		return 1;
+	}
+
+	for (int i = 0; i < bars->length; ++i) {
+		bar_run(bars->items[i]);
+	}
+	while (1) {
+		for (int i = 0; i < bars->length; ++i) {
+			struct swaybar *bar = bars->items[i];
+			wl_display_flush(bar->display);
+		}
+		loop_poll(eventloop);
+	}
 
-	bar_run(&swaybar);
-	bar_teardown(&swaybar);
+	teardown();
 	return 0;
 }
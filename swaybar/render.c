@@ -1,6 +1,9 @@
 #define _POSIX_C_SOURCE 200809L
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -124,7 +127,7 @@ static void i3bar_block_unref_callback(void *data) {
 
 static uint32_t render_status_block(cairo_t *cairo,
 		struct swaybar_output *output, struct i3bar_block *block, double *x,
-		bool edge) {
+		bool edge, int *hotspot_width) {
 	if (!block->full_text || !*block->full_text) {
 		return 0;
 	}
@@ -161,6 +164,7 @@ static uint32_t render_status_block(cairo_t *cairo,
 	}
 
 	int sep_width, sep_height;
+	int separator_block_width = block->separator_block_width;
 	if (!edge) {
 		if (config->sep_symbol) {
 			get_text_size(cairo, config->font, &sep_width, &sep_height, NULL,
@@ -170,28 +174,17 @@ static uint32_t render_status_block(cairo_t *cairo,
 			if (output->height < _ideal_surface_height) {
 				return _ideal_surface_height;
 			}
-			if (sep_width > block->separator_block_width) {
-				block->separator_block_width = sep_width + margin * 2;
+			if (sep_width > separator_block_width) {
+				separator_block_width = sep_width + margin * 2;
 			}
 		}
-		*x -= block->separator_block_width;
+		*x -= separator_block_width;
 	} else {
 		*x -= margin;
 	}
 
 	uint32_t height = output->height * output->scale;
-	if (output->bar->status->click_events) {
-		struct swaybar_hotspot *hotspot = calloc(1, sizeof(struct swaybar_hotspot));
-		hotspot->x = *x;
-		hotspot->y = 0;
-		hotspot->width = width;
-		hotspot->height = height;
-		hotspot->callback = block_hotspot_callback;
-		hotspot->destroy = i3bar_block_unref_callback;
-		hotspot->data = block;
-		block->ref_count++;
-		wl_list_insert(&output->hotspots, &hotspot->link);
-	}
+	*hotspot_width = width;
 
 	double pos = *x;
 	if (block->background) {
@@ -249,53 +242,24 @@ static uint32_t render_status_block(cairo_t *cairo,
 			cairo_set_source_u32(cairo, config->colors.separator);
 		}
 		if (config->sep_symbol) {
-			offset = pos + (block->separator_block_width - sep_width) / 2;
+			offset = pos + (separator_block_width - sep_width) / 2;
 			cairo_move_to(cairo, offset, height / 2.0 - sep_height / 2.0);
 			pango_printf(cairo, config->font, output->scale, false,
 					"%s", config->sep_symbol);
 		} else {
 			cairo_set_line_width(cairo, 1);
 			cairo_move_to(cairo,
-					pos + block->separator_block_width / 2, margin);
+					pos + separator_block_width / 2, margin);
 			cairo_line_to(cairo,
-					pos + block->separator_block_width / 2, height - margin);
+					pos + separator_block_width / 2, height - margin);
 			cairo_stroke(cairo);
 		}
 	}
 	return output->height;
 }
 
-static uint32_t render_status_line_i3bar(cairo_t *cairo,
-		struct swaybar_output *output, double *x) {
-	uint32_t max_height = 0;
-	bool edge = true;
-	struct i3bar_block *block;
-	wl_list_for_each(block, &output->bar->status->blocks, link) {
-		uint32_t h = render_status_block(cairo, output, block, x, edge);
-		max_height = h > max_height ? h : max_height;
-		edge = false;
-	}
-	return max_height;
-}
-
-static uint32_t render_status_line(cairo_t *cairo,
-		struct swaybar_output *output, double *x) {
-	struct status_line *status = output->bar->status;
-	switch (status->protocol) {
-	case PROTOCOL_ERROR:
-		return render_status_line_error(cairo, output, x);
-	case PROTOCOL_TEXT:
-		return render_status_line_text(cairo, output, x);
-	case PROTOCOL_I3BAR:
-		return render_status_line_i3bar(cairo, output, x);
-	case PROTOCOL_UNDEF:
-		return 0;
-	}
-	return 0;
-}
-
 static uint32_t render_binding_mode_indicator(cairo_t *cairo,
-		struct swaybar_output *output, double x) {
+		struct swaybar_output *output, double *x) {
 	struct swaybar_config *config = output->bar->config;
 	const char *mode = config->mode;
 	int text_width, text_height;
@@ -317,24 +281,26 @@ static uint32_t render_binding_mode_indicator(cairo_t *cairo,
 
 	uint32_t height = output->height * output->scale;
 	cairo_set_source_u32(cairo, config->colors.binding_mode.background);
-	cairo_rectangle(cairo, x, 0, width, height);
+	cairo_rectangle(cairo, *x, 0, width, height);
 	cairo_fill(cairo);
 
 	cairo_set_source_u32(cairo, config->colors.binding_mode.border);
-	cairo_rectangle(cairo, x, 0, width, border_width);
+	cairo_rectangle(cairo, *x, 0, width, border_width);
 	cairo_fill(cairo);
-	cairo_rectangle(cairo, x, 0, border_width, height);
+	cairo_rectangle(cairo, *x, 0, border_width, height);
 	cairo_fill(cairo);
-	cairo_rectangle(cairo, x + width - border_width, 0, border_width, height);
+	cairo_rectangle(cairo, *x + width - border_width, 0, border_width, height);
 	cairo_fill(cairo);
-	cairo_rectangle(cairo, x, height - border_width, width, border_width);
+	cairo_rectangle(cairo, *x, height - border_width, width, border_width);
 	cairo_fill(cairo);
 
 	double text_y = height / 2.0 - text_height / 2.0;
 	cairo_set_source_u32(cairo, config->colors.binding_mode.text);
-	cairo_move_to(cairo, x + width / 2 - text_width / 2, (int)floor(text_y));
+	cairo_move_to(cairo, *x + width / 2 - text_width / 2, (int)floor(text_y));
 	pango_printf(cairo, config->font, output->scale, config->mode_pango_markup,
 			"%s", mode);
+
+	*x += width;
 	return output->height;
 }
 
@@ -419,30 +385,300 @@ static uint32_t render_workspace_button(cairo_t *cairo,
 	pango_printf(cairo, config->font, output->scale, config->pango_markup,
 			"%s", name);
 
+	*x += width;
+	return output->height;
+}
+
+/**
+ * Each status block, workspace button and the binding mode indicator is drawn
+ * once into an image surface which is cached on the output, keyed by a string
+ * describing everything which affects how it looks. Frames are assembled by
+ * copying these surfaces into the buffer, so text is only shaped with pango
+ * when it changes, and only the x-ranges of items which changed are damaged.
+ */
+struct render_cache_entry {
+	struct wl_list link; // swaybar_output::render_cache
+	char *key;
+	uint32_t id;
+	cairo_surface_t *surface;
+	int width;
+	int hotspot_width;
+	uint32_t ideal_height;
+	bool used;
+};
+
+// An item as placed in a frame
+struct render_item {
+	uint32_t id;
+	int x, width;
+	struct render_cache_entry *entry;
+};
+
+typedef uint32_t (*render_item_func_t)(cairo_t *cairo,
+		struct swaybar_output *output, double *x, void *data,
+		int *hotspot_width);
+
+static char *cache_key(struct swaybar_output *output, const char *fmt, ...) {
+	// Everything which applies to all items on the output goes first
+	const char *font = output->bar->config->font;
+	int prefix_len = snprintf(NULL, 0, "%u|%d|%d|%d|%s|", output->height,
+			output->scale, output->subpixel, output->focused, font);
+
+	va_list args;
+	va_start(args, fmt);
+	int len = vsnprintf(NULL, 0, fmt, args);
+	va_end(args);
+
+	char *key = malloc(prefix_len + len + 1);
+	if (!key) {
+		return NULL;
+	}
+	snprintf(key, prefix_len + 1, "%u|%d|%d|%d|%s|", output->height,
+			output->scale, output->subpixel, output->focused, font);
+	va_start(args, fmt);
+	vsnprintf(key + prefix_len, len + 1, fmt, args);
+	va_end(args);
+	return key;
+}
+
+static void render_cache_entry_destroy(struct render_cache_entry *entry) {
+	wl_list_remove(&entry->link);
+	if (entry->surface) {
+		cairo_surface_destroy(entry->surface);
+	}
+	free(entry->key);
+	free(entry);
+}
+
+void render_free_cache(struct swaybar_output *output) {
+	struct render_cache_entry *entry, *tmp;
+	wl_list_for_each_safe(entry, tmp, &output->render_cache, link) {
+		render_cache_entry_destroy(entry);
+	}
+	wl_array_release(&output->last_frame.items);
+	wl_array_init(&output->last_frame.items);
+}
+
+static uint32_t get_background(struct swaybar_output *output) {
+	struct swaybar_config *config = output->bar->config;
+	return output->focused ?
+		config->colors.focused_background : config->colors.background;
+}
+
+static void set_font_options(cairo_t *cairo, struct swaybar_output *output) {
+	cairo_set_antialias(cairo, CAIRO_ANTIALIAS_BEST);
+	cairo_font_options_t *fo = cairo_font_options_create();
+	cairo_font_options_set_hint_style(fo, CAIRO_HINT_STYLE_FULL);
+	cairo_font_options_set_antialias(fo, CAIRO_ANTIALIAS_SUBPIXEL);
+	cairo_font_options_set_subpixel_order(fo, to_cairo_subpixel_order(output->subpixel));
+	cairo_set_font_options(cairo, fo);
+	cairo_font_options_destroy(fo);
+}
+
+/**
+ * Returns the cached surface for the given key, drawing it with func if
+ * necessary. Items drawn right to left (rtl) move x towards zero.
+ */
+static struct render_cache_entry *get_cached_item(
+		struct swaybar_output *output, char *key, render_item_func_t func,
+		void *data, bool rtl) {
+	static uint32_t next_id = 1;
+	if (!key) {
+		return NULL;
+	}
+	struct render_cache_entry *entry;
+	wl_list_for_each(entry, &output->render_cache, link) {
+		if (strcmp(entry->key, key) == 0) {
+			free(key);
+			entry->used = true;
+			return entry;
+		}
+	}
+
+	entry = calloc(1, sizeof(struct render_cache_entry));
+	if (!entry) {
+		free(key);
+		return NULL;
+	}
+	entry->key = key;
+	entry->id = next_id++;
+	entry->used = true;
+
+	cairo_surface_t *recorder = cairo_recording_surface_create(
+			CAIRO_CONTENT_COLOR_ALPHA, NULL);
+	cairo_t *cairo = cairo_create(recorder);
+	set_font_options(cairo, output);
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	double x = 0;
+	entry->hotspot_width = -1;
+	entry->ideal_height = func(cairo, output, &x, data, &entry->hotspot_width);
+	entry->width = (int)ceil(fabs(x));
+	if (entry->hotspot_width < 0) {
+		entry->hotspot_width = entry->width;
+	}
+
+	int height = output->height * output->scale;
+	if (entry->width > 0 && height > 0) {
+		entry->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+				entry->width, height);
+		cairo_t *image = cairo_create(entry->surface);
+		cairo_set_operator(image, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_u32(image, get_background(output));
+		cairo_paint(image);
+		cairo_set_operator(image, CAIRO_OPERATOR_OVER);
+		cairo_set_source_surface(image, recorder, rtl ? -x : 0, 0);
+		cairo_paint(image);
+		cairo_destroy(image);
+	}
+	cairo_destroy(cairo);
+	cairo_surface_destroy(recorder);
+
+	wl_list_insert(&output->render_cache, &entry->link);
+	return entry;
+}
+
+static void add_hotspot(struct swaybar_output *output,
+		struct render_item *item, enum hotspot_event_handling (*callback)(
+			struct swaybar_output *output, int x, int y,
+			enum x11_button button, void *data),
+		void (*destroy)(void *data), void *data) {
 	struct swaybar_hotspot *hotspot = calloc(1, sizeof(struct swaybar_hotspot));
-	hotspot->x = *x;
+	hotspot->x = item->x;
 	hotspot->y = 0;
-	hotspot->width = width;
-	hotspot->height = height;
-	hotspot->callback = workspace_hotspot_callback;
-	hotspot->destroy = free;
-	hotspot->data = strdup(ws->name);
+	hotspot->width = item->entry->hotspot_width;
+	hotspot->height = output->height * output->scale;
+	hotspot->callback = callback;
+	hotspot->destroy = destroy;
+	hotspot->data = data;
 	wl_list_insert(&output->hotspots, &hotspot->link);
+}
 
-	*x += width;
-	return output->height;
+static struct render_item *place_item(struct wl_array *items,
+		struct render_cache_entry *entry, int x) {
+	if (!entry) {
+		return NULL;
+	}
+	struct render_item *item = wl_array_add(items, sizeof(struct render_item));
+	if (!item) {
+		return NULL;
+	}
+	item->id = entry->id;
+	item->x = x;
+	item->width = entry->width;
+	item->entry = entry;
+	return item;
 }
 
-static uint32_t render_to_cairo(cairo_t *cairo, struct swaybar_output *output) {
+static uint32_t render_status_error_item(cairo_t *cairo,
+		struct swaybar_output *output, double *x, void *data,
+		int *hotspot_width) {
+	return render_status_line_error(cairo, output, x);
+}
+
+static uint32_t render_status_text_item(cairo_t *cairo,
+		struct swaybar_output *output, double *x, void *data,
+		int *hotspot_width) {
+	return render_status_line_text(cairo, output, x);
+}
+
+struct status_block_item {
+	struct i3bar_block *block;
+	bool edge;
+};
+
+static uint32_t render_status_block_item(cairo_t *cairo,
+		struct swaybar_output *output, double *x, void *data,
+		int *hotspot_width) {
+	struct status_block_item *item = data;
+	return render_status_block(cairo, output, item->block, x, item->edge,
+			hotspot_width);
+}
+
+static uint32_t render_workspace_item(cairo_t *cairo,
+		struct swaybar_output *output, double *x, void *data,
+		int *hotspot_width) {
+	return render_workspace_button(cairo, output, data, x);
+}
+
+static uint32_t render_binding_mode_item(cairo_t *cairo,
+		struct swaybar_output *output, double *x, void *data,
+		int *hotspot_width) {
+	return render_binding_mode_indicator(cairo, output, x);
+}
+
+static uint32_t layout_status_line(struct swaybar_output *output,
+		struct wl_array *items, double *x) {
+	struct status_line *status = output->bar->status;
+	struct swaybar_config *config = output->bar->config;
+	struct render_cache_entry *entry = NULL;
+	switch (status->protocol) {
+	case PROTOCOL_ERROR:
+		if (!status->text) {
+			return 0;
+		}
+		entry = get_cached_item(output, cache_key(output, "error|%s",
+					status->text), render_status_error_item, NULL, true);
+		break;
+	case PROTOCOL_TEXT:
+		if (!status->text) {
+			return 0;
+		}
+		entry = get_cached_item(output, cache_key(output, "text|%d|%s",
+					config->pango_markup, status->text),
+				render_status_text_item, NULL, true);
+		break;
+	case PROTOCOL_I3BAR:;
+		uint32_t max_height = 0;
+		bool edge = true;
+		struct i3bar_block *block;
+		wl_list_for_each(block, &status->blocks, link) {
+			struct status_block_item data = { block, edge };
+			char *key = cache_key(output,
+					"block|%d|%d|%s|%d|%s|%u|%u|%u|%d|%d|%d|%d|%d|%d|%s|%s",
+					edge, block->markup, block->align, block->min_width,
+					block->color ? "c" : "", block->color ? *block->color : 0,
+					block->background, block->border, block->border_top,
+					block->border_bottom, block->border_left,
+					block->border_right, block->separator,
+					block->separator_block_width,
+					config->sep_symbol ? config->sep_symbol : "",
+					block->full_text ? block->full_text : "");
+			entry = get_cached_item(output, key,
+					render_status_block_item, &data, true);
+			edge = false;
+			if (!entry) {
+				continue;
+			}
+			max_height = entry->ideal_height > max_height ?
+				entry->ideal_height : max_height;
+			*x -= entry->width;
+			struct render_item *item = place_item(items, entry, *x);
+			if (item && entry->width > 0 && status->click_events) {
+				block->ref_count++;
+				add_hotspot(output, item, block_hotspot_callback,
+						i3bar_block_unref_callback, block);
+			}
+		}
+		return max_height;
+	case PROTOCOL_UNDEF:
+		return 0;
+	}
+	if (!entry) {
+		return 0;
+	}
+	*x -= entry->width;
+	place_item(items, entry, *x);
+	return entry->ideal_height;
+}
+
+/**
+ * Work out which cached items make up the frame and where they go. Returns
+ * the ideal height of the bar.
+ */
+static uint32_t layout_frame(struct swaybar_output *output,
+		struct wl_array *items) {
 	struct swaybar *bar = output->bar;
 	struct swaybar_config *config = bar->config;
-	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
-	if (output->focused) {
-		cairo_set_source_u32(cairo, config->colors.focused_background);
-	} else {
-		cairo_set_source_u32(cairo, config->colors.background);
-	}
-	cairo_paint(cairo);
 
 	uint32_t max_height = 0;
 	/*
@@ -454,25 +690,87 @@ static uint32_t render_to_cairo(cairo_t *cairo, struct swaybar_output *output) {
 	 */
 	double x = output->width * output->scale;
 	if (bar->status) {
-		uint32_t h = render_status_line(cairo, output, &x);
+		uint32_t h = layout_status_line(output, items, &x);
 		max_height = h > max_height ? h : max_height;
 	}
 	x = 0;
 	if (config->workspace_buttons) {
 		struct swaybar_workspace *ws;
 		wl_list_for_each_reverse(ws, &output->workspaces, link) {
-			uint32_t h = render_workspace_button(cairo, output, ws, &x);
-			max_height = h > max_height ? h : max_height;
+			char *key = cache_key(output, "ws|%d|%d|%d|%d|%d|%s",
+					config->strip_workspace_numbers, ws->urgent, ws->focused,
+					ws->visible, config->pango_markup, ws->name);
+			struct render_cache_entry *entry = get_cached_item(output, key,
+					render_workspace_item, ws, false);
+			if (!entry) {
+				continue;
+			}
+			max_height = entry->ideal_height > max_height ?
+				entry->ideal_height : max_height;
+			struct render_item *item = place_item(items, entry, x);
+			if (item && entry->width > 0) {
+				add_hotspot(output, item, workspace_hotspot_callback,
+						free, strdup(ws->name));
+			}
+			x += entry->width;
 		}
 	}
 	if (config->binding_mode_indicator && config->mode) {
-		uint32_t h = render_binding_mode_indicator(cairo, output, x);
-		max_height = h > max_height ? h : max_height;
+		char *key = cache_key(output, "mode|%d|%s",
+				config->mode_pango_markup, config->mode);
+		struct render_cache_entry *entry = get_cached_item(output, key,
+				render_binding_mode_item, NULL, false);
+		if (entry) {
+			max_height = entry->ideal_height > max_height ?
+				entry->ideal_height : max_height;
+			place_item(items, entry, x);
+		}
 	}
 
 	return max_height > output->height ? max_height : output->height;
 }
 
+static bool frame_has_item(struct wl_array *items, struct render_item *item) {
+	struct render_item *iter;
+	wl_array_for_each(iter, items) {
+		if (iter->id == item->id && iter->x == item->x &&
+				iter->width == item->width) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void damage_range(struct swaybar_output *output, int x, int width) {
+	// Buffer coordinates to surface coordinates, rounding outwards
+	int x1 = x / output->scale;
+	int x2 = (x + width + output->scale - 1) / output->scale;
+	wl_surface_damage(output->surface, x1, 0, x2 - x1, output->height);
+}
+
+static void damage_frame(struct swaybar_output *output,
+		struct wl_array *items) {
+	struct swaybar_output_frame *last = &output->last_frame;
+	if (last->width != output->width || last->height != output->height ||
+			last->scale != output->scale ||
+			last->background != get_background(output)) {
+		wl_surface_damage(output->surface, 0, 0,
+				output->width, output->height);
+		return;
+	}
+	struct render_item *item;
+	wl_array_for_each(item, items) {
+		if (!frame_has_item(&last->items, item)) {
+			damage_range(output, item->x, item->width);
+		}
+	}
+	wl_array_for_each(item, &last->items) {
+		if (!frame_has_item(items, item)) {
+			damage_range(output, item->x, item->width);
+		}
+	}
+}
+
 static void output_frame_handle_done(void *data, struct wl_callback *callback,
 		uint32_t time) {
 	wl_callback_destroy(callback);
@@ -500,21 +798,14 @@ void render_frame(struct swaybar_output *output) {
 		free(hotspot);
 	}
 
-	cairo_surface_t *recorder = cairo_recording_surface_create(
-			CAIRO_CONTENT_COLOR_ALPHA, NULL);
-	cairo_t *cairo = cairo_create(recorder);
-	cairo_set_antialias(cairo, CAIRO_ANTIALIAS_BEST);
-	cairo_font_options_t *fo = cairo_font_options_create();
-	cairo_font_options_set_hint_style(fo, CAIRO_HINT_STYLE_FULL);
-	cairo_font_options_set_antialias(fo, CAIRO_ANTIALIAS_SUBPIXEL);
-	cairo_font_options_set_subpixel_order(fo, to_cairo_subpixel_order(output->subpixel));
-	cairo_set_font_options(cairo, fo);
-	cairo_font_options_destroy(fo);
-	cairo_save(cairo);
-	cairo_set_operator(cairo, CAIRO_OPERATOR_CLEAR);
-	cairo_paint(cairo);
-	cairo_restore(cairo);
-	uint32_t height = render_to_cairo(cairo, output);
+	struct render_cache_entry *entry, *entry_tmp;
+	wl_list_for_each(entry, &output->render_cache, link) {
+		entry->used = false;
+	}
+
+	struct wl_array items;
+	wl_array_init(&items);
+	uint32_t height = layout_frame(output, &items);
 	int config_height = output->bar->config->height;
 	if (config_height >= 0 && height < (uint32_t)config_height) {
 		height = config_height;
@@ -527,38 +818,58 @@ void render_frame(struct swaybar_output *output) {
 		// different height than what we asked for
 		wl_surface_commit(output->surface);
 	} else if (height > 0) {
-		// Replay recording into shm and send it off
+		// Copy the cached items into shm and send it off
 		output->current_buffer = get_next_buffer(output->bar->shm,
 				output->buffers,
 				output->width * output->scale,
 				output->height * output->scale);
 		if (!output->current_buffer) {
-			cairo_surface_destroy(recorder);
-			cairo_destroy(cairo);
+			wl_array_release(&items);
 			return;
 		}
 		cairo_t *shm = output->current_buffer->cairo;
 
 		cairo_save(shm);
-		cairo_set_operator(shm, CAIRO_OPERATOR_CLEAR);
+		cairo_set_operator(shm, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_u32(shm, get_background(output));
 		cairo_paint(shm);
+		struct render_item *item;
+		wl_array_for_each(item, &items) {
+			if (!item->entry->surface) {
+				continue;
+			}
+			cairo_set_source_surface(shm, item->entry->surface, item->x, 0);
+			cairo_rectangle(shm, item->x, 0, item->width,
+					output->height * output->scale);
+			cairo_fill(shm);
+		}
 		cairo_restore(shm);
 
-		cairo_set_source_surface(shm, recorder, 0.0, 0.0);
-		cairo_paint(shm);
-
 		wl_surface_set_buffer_scale(output->surface, output->scale);
 		wl_surface_attach(output->surface,
 				output->current_buffer->buffer, 0, 0);
-		wl_surface_damage(output->surface, 0, 0,
-				output->width, output->height);
+		damage_frame(output, &items);
 
 		struct wl_callback *frame_callback = wl_surface_frame(output->surface);
 		wl_callback_add_listener(frame_callback, &output_frame_listener, output);
 		output->frame_scheduled = true;
 
 		wl_surface_commit(output->surface);
+
+		struct swaybar_output_frame *last = &output->last_frame;
+		wl_array_release(&last->items);
+		last->items = items;
+		last->width = output->width;
+		last->height = output->height;
+		last->scale = output->scale;
+		last->background = get_background(output);
+		wl_array_init(&items);
+	}
+	wl_array_release(&items);
+
+	wl_list_for_each_safe(entry, entry_tmp, &output->render_cache, link) {
+		if (!entry->used) {
+			render_cache_entry_destroy(entry);
+		}
 	}
-	cairo_surface_destroy(recorder);
-	cairo_destroy(cairo);
 }
@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <json-c/json.h>
 #include <stdlib.h>
@@ -10,13 +11,15 @@
 #include "swaybar/bar.h"
 #include "swaybar/config.h"
 #include "swaybar/i3bar.h"
-#include "swaybar/event_loop.h"
 #include "swaybar/status_line.h"
 #include "readline.h"
 
+// Status lines shared by the bars in this process
+static list_t *status_lines = NULL;
+
 static void status_line_close_fds(struct status_line *status) {
 	if (status->read_fd != -1) {
-		remove_event(status->read_fd);
+		loop_remove_fd(status->eventloop, status->read_fd);
 		close(status->read_fd);
 		status->read_fd = -1;
 	}
@@ -119,8 +122,40 @@ bool status_handle_readable(struct status_line *status) {
 	}
 }
 
-struct status_line *status_line_init(char *cmd) {
+static void status_in(int fd, short mask, void *data) {
+	struct status_line *status = data;
+	bool dirty;
+	if (mask & (POLLHUP | POLLERR)) {
+		status_error(status, "[error reading from status command]");
+		dirty = true;
+	} else {
+		dirty = status_handle_readable(status);
+	}
+	if (dirty) {
+		for (int i = 0; i < status->bars->length; ++i) {
+			set_bar_dirty(status->bars->items[i]);
+		}
+	}
+}
+
+struct status_line *status_line_init(struct swaybar *bar, char *cmd) {
+	if (!status_lines) {
+		status_lines = create_list();
+	}
+	for (int i = 0; i < status_lines->length; ++i) {
+		struct status_line *status = status_lines->items[i];
+		if (strcmp(status->command, cmd) == 0) {
+			wlr_log(WLR_DEBUG, "Sharing status command: %s", cmd);
+			list_add(status->bars, bar);
+			return status;
+		}
+	}
+
 	struct status_line *status = calloc(1, sizeof(struct status_line));
+	status->command = strdup(cmd);
+	status->bars = create_list();
+	list_add(status->bars, bar);
+	status->eventloop = bar->eventloop;
 	status->buffer_size = 8192;
 	status->buffer = malloc(status->buffer_size);
 
@@ -155,10 +190,13 @@ struct status_line *status_line_init(char *cmd) {
 
 	status->read = fdopen(status->read_fd, "r");
 	status->write = fdopen(status->write_fd, "w");
+
+	loop_add_fd(status->eventloop, status->read_fd, POLLIN, status_in, status);
+	list_add(status_lines, status);
 	return status;
 }
 
-void status_line_free(struct status_line *status) {
+static void status_line_free(struct status_line *status) {
 	status_line_close_fds(status);
 	kill(status->pid, SIGTERM);
 	if (status->protocol == PROTOCOL_I3BAR) {
@@ -170,5 +208,22 @@ void status_line_free(struct status_line *status) {
 		json_tokener_free(status->tokener);
 	}
 	free(status->buffer);
+	free(status->command);
+	list_free(status->bars);
 	free(status);
 }
+
+void status_line_release(struct status_line *status, struct swaybar *bar) {
+	int index = list_find(status->bars, bar);
+	if (index != -1) {
+		list_del(status->bars, index);
+	}
+	if (status->bars->length > 0) {
+		return;
+	}
+	index = list_find(status_lines, status);
+	if (index != -1) {
+		list_del(status_lines, index);
+	}
+	status_line_free(status);
+}
@@ -20,32 +20,61 @@ struct swaybg_args {
 	const char *fallback;
 };
 
-struct swaybg_context {
+// A decoded image, shared by every output showing the same file
+struct swaybg_image {
+	struct wl_list link; // swaybg_state::images
+	const char *path;
+	cairo_surface_t *surface; // Full size, freed once no output needs it
+};
+
+// A background scaled to one buffer size, shared by outputs of that size
+struct swaybg_frame {
+	struct wl_list link; // swaybg_state::frames
+	int refs;
+	struct swaybg_image *image;
+	enum background_mode mode;
 	uint32_t color;
-	cairo_surface_t *image;
+	int width, height;
+	cairo_surface_t *surface;
 };
 
-struct swaybg_state {
+struct swaybg_output {
+	struct wl_list link; // swaybg_state::outputs
+	struct swaybg_state *state;
 	const struct swaybg_args *args;
-	struct swaybg_context context;
-
-	struct wl_display *display;
-	struct wl_compositor *compositor;
-	struct zwlr_layer_shell_v1 *layer_shell;
-	struct wl_shm *shm;
+	uint32_t color;
+	struct swaybg_image *image;
+	struct swaybg_frame *frame;
 
 	struct wl_output *output;
 	struct wl_surface *surface;
 	struct wl_region *input_region;
 	struct zwlr_layer_surface_v1 *layer_surface;
 
-	bool run_display;
+	bool configured;
 	uint32_t width, height;
 	int32_t scale;
-	struct pool_buffer buffers[2];
+	struct pool_buffer buffers[POOL_BUFFER_COUNT];
 	struct pool_buffer *current_buffer;
 };
 
+struct swaybg_state {
+	struct swaybg_args *args;
+	int args_count;
+
+	struct wl_display *display;
+	struct wl_compositor *compositor;
+	struct zwlr_layer_shell_v1 *layer_shell;
+	struct wl_shm *shm;
+
+	struct wl_list outputs; // swaybg_output::link
+	struct wl_list images; // swaybg_image::link
+	struct wl_list frames; // swaybg_frame::link
+	int output_count; // wl_output globals seen so far
+
+	bool run_display;
+};
+
 bool is_valid_color(const char *color) {
 	int len = strlen(color);
 	if (len != 7 || color[0] != '#') {
@@ -64,68 +93,211 @@ bool is_valid_color(const char *color) {
 	return true;
 }
 
-static void render_frame(struct swaybg_state *state) {
-	int buffer_width = state->width * state->scale,
-		buffer_height = state->height * state->scale;
-	state->current_buffer = get_next_buffer(state->shm,
-			state->buffers, buffer_width, buffer_height);
-	if (!state->current_buffer) {
-		return;
+static struct swaybg_image *get_image(struct swaybg_state *state,
+		const char *path) {
+	struct swaybg_image *image;
+	wl_list_for_each(image, &state->images, link) {
+		if (strcmp(image->path, path) == 0) {
+			return image;
+		}
 	}
-	cairo_t *cairo = state->current_buffer->cairo;
-	cairo_save(cairo);
-	cairo_set_operator(cairo, CAIRO_OPERATOR_CLEAR);
-	cairo_paint(cairo);
-	cairo_restore(cairo);
-	if (state->args->mode == BACKGROUND_MODE_SOLID_COLOR) {
-		cairo_set_source_u32(cairo, state->context.color);
-		cairo_paint(cairo);
-	} else {
-		if (state->args->fallback && state->context.color) {
-			cairo_set_source_u32(cairo, state->context.color);
-			cairo_paint(cairo);
+	image = calloc(1, sizeof(struct swaybg_image));
+	if (!image) {
+		return NULL;
+	}
+	image->path = path;
+	if (!(image->surface = load_background_image(path))) {
+		free(image);
+		return NULL;
+	}
+	wl_list_insert(&state->images, &image->link);
+	return image;
+}
+
+// Frees the full size image once every output showing it has been scaled
+static void release_image(struct swaybg_state *state,
+		struct swaybg_image *image) {
+	struct swaybg_output *output;
+	wl_list_for_each(output, &state->outputs, link) {
+		if (output->image == image && !output->frame) {
+			return;
 		}
-		render_background_image(cairo, state->context.image,
-				state->args->mode, buffer_width, buffer_height);
 	}
+	if (image->surface) {
+		cairo_surface_destroy(image->surface);
+		image->surface = NULL;
+	}
+}
 
-	wl_surface_set_buffer_scale(state->surface, state->scale);
-	wl_surface_attach(state->surface, state->current_buffer->buffer, 0, 0);
-	wl_surface_damage(state->surface, 0, 0, state->width, state->height);
-	wl_surface_commit(state->surface);
+static void frame_unref(struct swaybg_frame *frame) {
+	if (frame && --frame->refs == 0) {
+		wl_list_remove(&frame->link);
+		cairo_surface_destroy(frame->surface);
+		free(frame);
+	}
 }
 
-static bool prepare_context(struct swaybg_state *state) {
-	if (state->args->mode == BACKGROUND_MODE_SOLID_COLOR) {
-		state->context.color = parse_color(state->args->path);
-		return is_valid_color(state->args->path);
+/**
+ * Finds or renders the output's background at its buffer size. Images are
+ * only decoded again if an output's size changes after they were freed.
+ */
+static bool prepare_frame(struct swaybg_output *output,
+		int buffer_width, int buffer_height) {
+	struct swaybg_frame *frame = output->frame;
+	if (frame && frame->width == buffer_width &&
+			frame->height == buffer_height) {
+		return true;
+	}
+	frame_unref(frame);
+	output->frame = NULL;
+
+	struct swaybg_state *state = output->state;
+	wl_list_for_each(frame, &state->frames, link) {
+		if (frame->image == output->image &&
+				frame->mode == output->args->mode &&
+				frame->color == output->color &&
+				frame->width == buffer_width &&
+				frame->height == buffer_height) {
+			frame->refs++;
+			output->frame = frame;
+			release_image(state, output->image);
+			return true;
+		}
 	}
-	if (state->args->fallback && is_valid_color(state->args->fallback)) {
-		state->context.color = parse_color(state->args->fallback);
+
+	struct swaybg_image *image = output->image;
+	if (!image->surface &&
+			!(image->surface = load_background_image(image->path))) {
+		return false;
 	}
-	if (!(state->context.image = load_background_image(state->args->path))) {
+	frame = calloc(1, sizeof(struct swaybg_frame));
+	if (!frame) {
 		return false;
 	}
+	frame->refs = 1;
+	frame->image = image;
+	frame->mode = output->args->mode;
+	frame->color = output->color;
+	frame->width = buffer_width;
+	frame->height = buffer_height;
+	frame->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+			buffer_width, buffer_height);
+	cairo_t *cairo = cairo_create(frame->surface);
+	if (frame->color) {
+		cairo_set_source_u32(cairo, frame->color);
+		cairo_paint(cairo);
+	}
+	render_background_image(cairo, image->surface,
+			frame->mode, buffer_width, buffer_height);
+	cairo_destroy(cairo);
+	cairo_surface_flush(frame->surface);
+	wl_list_insert(&state->frames, &frame->link);
+
+	output->frame = frame;
+	release_image(state, image);
 	return true;
 }
 
+static void copy_frame(cairo_surface_t *frame, struct pool_buffer *buffer) {
+	unsigned char *src = cairo_image_surface_get_data(frame);
+	int src_stride = cairo_image_surface_get_stride(frame);
+	unsigned char *dst = buffer->data;
+	int dst_stride = buffer->width * 4;
+	if (src_stride == dst_stride) {
+		memcpy(dst, src, (size_t)dst_stride * buffer->height);
+	} else {
+		for (uint32_t y = 0; y < buffer->height; ++y) {
+			memcpy(dst + y * dst_stride, src + y * src_stride, dst_stride);
+		}
+	}
+	cairo_surface_mark_dirty(buffer->surface);
+}
+
+static void render_frame(struct swaybg_output *output) {
+	int buffer_width = output->width * output->scale,
+		buffer_height = output->height * output->scale;
+	if (buffer_width == 0 || buffer_height == 0) {
+		return;
+	}
+	if (output->args->mode != BACKGROUND_MODE_SOLID_COLOR &&
+			!prepare_frame(output, buffer_width, buffer_height)) {
+		return;
+	}
+	output->current_buffer = get_next_buffer(output->state->shm,
+			output->buffers, buffer_width, buffer_height);
+	if (!output->current_buffer) {
+		return;
+	}
+	if (output->args->mode == BACKGROUND_MODE_SOLID_COLOR) {
+		cairo_t *cairo = output->current_buffer->cairo;
+		cairo_save(cairo);
+		cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_u32(cairo, output->color);
+		cairo_paint(cairo);
+		cairo_restore(cairo);
+	} else {
+		copy_frame(output->frame->surface, output->current_buffer);
+	}
+
+	wl_surface_set_buffer_scale(output->surface, output->scale);
+	wl_surface_attach(output->surface, output->current_buffer->buffer, 0, 0);
+	wl_surface_damage(output->surface, 0, 0, output->width, output->height);
+	wl_surface_commit(output->surface);
+}
+
+static bool prepare_output(struct swaybg_state *state,
+		struct swaybg_output *output) {
+	const struct swaybg_args *args = output->args;
+	if (args->mode == BACKGROUND_MODE_SOLID_COLOR) {
+		output->color = parse_color(args->path);
+		return is_valid_color(args->path);
+	}
+	if (args->fallback && is_valid_color(args->fallback)) {
+		output->color = parse_color(args->fallback);
+	}
+	return (output->image = get_image(state, args->path)) != NULL;
+}
+
+static void destroy_output(struct swaybg_output *output) {
+	struct swaybg_state *state = output->state;
+	wl_list_remove(&output->link);
+	if (output->layer_surface) {
+		zwlr_layer_surface_v1_destroy(output->layer_surface);
+	}
+	if (output->surface) {
+		wl_surface_destroy(output->surface);
+	}
+	if (output->input_region) {
+		wl_region_destroy(output->input_region);
+	}
+	if (output->output) {
+		wl_output_destroy(output->output);
+	}
+	for (size_t i = 0; i < POOL_BUFFER_COUNT; ++i) {
+		destroy_buffer(&output->buffers[i]);
+	}
+	frame_unref(output->frame);
+	free(output);
+	if (wl_list_empty(&state->outputs)) {
+		state->run_display = false;
+	}
+}
+
 static void layer_surface_configure(void *data,
 		struct zwlr_layer_surface_v1 *surface,
 		uint32_t serial, uint32_t width, uint32_t height) {
-	struct swaybg_state *state = data;
-	state->width = width;
-	state->height = height;
+	struct swaybg_output *output = data;
+	output->width = width;
+	output->height = height;
+	output->configured = true;
 	zwlr_layer_surface_v1_ack_configure(surface, serial);
-	render_frame(state);
+	render_frame(output);
 }
 
 static void layer_surface_closed(void *data,
 		struct zwlr_layer_surface_v1 *surface) {
-	struct swaybg_state *state = data;
-	zwlr_layer_surface_v1_destroy(state->layer_surface);
-	wl_surface_destroy(state->surface);
-	wl_region_destroy(state->input_region);
-	state->run_display = false;
+	struct swaybg_output *output = data;
+	destroy_output(output);
 }
 
 static const struct zwlr_layer_surface_v1_listener layer_surface_listener = {
@@ -148,11 +320,12 @@ static void output_done(void *data, struct wl_output *output) {
 	// Who cares
 }
 
-static void output_scale(void *data, struct wl_output *output, int32_t factor) {
-	struct swaybg_state *state = data;
-	state->scale = factor;
-	if (state->run_display) {
-		render_frame(state);
+static void output_scale(void *data, struct wl_output *wl_output,
+		int32_t factor) {
+	struct swaybg_output *output = data;
+	output->scale = factor;
+	if (output->configured) {
+		render_frame(output);
 	}
 }
 
@@ -173,13 +346,29 @@ static void handle_global(void *data, struct wl_registry *registry,
 		state->shm = wl_registry_bind(registry, name,
 				&wl_shm_interface, 1);
 	} else if (strcmp(interface, wl_output_interface.name) == 0) {
-		static int output_idx = 0;
-		if (output_idx == state->args->output_idx) {
-			state->output = wl_registry_bind(registry, name,
+		int output_idx = state->output_count++;
+		for (int i = 0; i < state->args_count; ++i) {
+			if (state->args[i].output_idx != output_idx) {
+				continue;
+			}
+			struct swaybg_output *output =
+				calloc(1, sizeof(struct swaybg_output));
+			if (!output) {
+				break;
+			}
+			output->state = state;
+			output->args = &state->args[i];
+			output->scale = 1;
+			wl_list_insert(&state->outputs, &output->link);
+			if (!prepare_output(state, output)) {
+				destroy_output(output);
+				break;
+			}
+			output->output = wl_registry_bind(registry, name,
 					&wl_output_interface, 3);
-			wl_output_add_listener(state->output, &output_listener, state);
+			wl_output_add_listener(output->output, &output_listener, output);
+			break;
 		}
-		output_idx++;
 	} else if (strcmp(interface, zwlr_layer_shell_v1_interface.name) == 0) {
 		state->layer_shell = wl_registry_bind(
 				registry, name, &zwlr_layer_shell_v1_interface, 1);
@@ -196,29 +385,46 @@ static const struct wl_registry_listener registry_listener = {
 	.global_remove = handle_global_remove,
 };
 
+static bool parse_args(struct swaybg_args *args, const char **argv,
+		int count) {
+	args->output_idx = atoi(argv[0]);
+	args->path = argv[1];
+	args->mode = parse_background_mode(argv[2]);
+	if (args->mode == BACKGROUND_MODE_INVALID) {
+		return false;
+	}
+	args->fallback = count == 4 && strcmp(argv[3], "-") != 0 ?
+		argv[3] : NULL;
+	return true;
+}
+
 int main(int argc, const char **argv) {
-	struct swaybg_args args = {0};
 	struct swaybg_state state = {0};
-	state.args = &args;
+	wl_list_init(&state.outputs);
+	wl_list_init(&state.images);
+	wl_list_init(&state.frames);
 	wlr_log_init(WLR_DEBUG, NULL);
 
-	if (argc < 4 || argc > 5) {
+	/*
+	 * Either a single "<output> <path> <mode> [<fallback>]", or any number of
+	 * "<output> <path> <mode> <fallback>" groups with "-" for no fallback.
+	 */
+	int count = argc - 1;
+	if (count != 3 && (count < 4 || count % 4 != 0)) {
 		wlr_log(WLR_ERROR, "Do not run this program manually. "
 				"See man 5 sway and look for output options.");
 		return 1;
 	}
-	args.output_idx = atoi(argv[1]);
-	args.path = argv[2];
-
-	args.mode = parse_background_mode(argv[3]);
-	if (args.mode == BACKGROUND_MODE_INVALID) {
+	state.args_count = count == 3 ? 1 : count / 4;
+	state.args = calloc(state.args_count, sizeof(struct swaybg_args));
+	if (!state.args) {
 		return 1;
 	}
-
-	args.fallback = argc == 5 ? argv[4] : NULL;
-
-	if (!prepare_context(&state)) {
-		return 1;
+	for (int i = 0; i < state.args_count; ++i) {
+		if (!parse_args(&state.args[i], &argv[1 + i * 4],
+					count == 3 ? 3 : 4)) {
+			return 1;
+		}
 	}
 
 	state.display = wl_display_connect(NULL);
@@ -227,37 +433,44 @@ int main(int argc, const char **argv) {
 	struct wl_registry *registry = wl_display_get_registry(state.display);
 	wl_registry_add_listener(registry, &registry_listener, &state);
 	wl_display_roundtrip(state.display);
-	assert(state.compositor && state.layer_shell && state.output && state.shm);
+	assert(state.compositor && state.layer_shell && state.shm);
+	if (wl_list_empty(&state.outputs)) {
+		wlr_log(WLR_ERROR, "No outputs to set the background on");
+		return 1;
+	}
 
 	// Second roundtrip to get output properties
 	wl_display_roundtrip(state.display);
 
-	state.surface = wl_compositor_create_surface(state.compositor);
-	assert(state.surface);
-
-	state.input_region = wl_compositor_create_region(state.compositor);
-	assert(state.input_region);
-	wl_surface_set_input_region(state.surface, state.input_region);
-
-	state.layer_surface = zwlr_layer_shell_v1_get_layer_surface(
-			state.layer_shell, state.surface, state.output,
-			ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND, "wallpaper");
-	assert(state.layer_surface);
-
-	zwlr_layer_surface_v1_set_size(state.layer_surface, 0, 0);
-	zwlr_layer_surface_v1_set_anchor(state.layer_surface,
-			ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP |
-			ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT |
-			ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM |
-			ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT);
-	zwlr_layer_surface_v1_set_exclusive_zone(state.layer_surface, -1);
-	zwlr_layer_surface_v1_add_listener(state.layer_surface,
-			&layer_surface_listener, &state);
-	wl_surface_commit(state.surface);
+	struct swaybg_output *output;
+	wl_list_for_each(output, &state.outputs, link) {
+		output->surface = wl_compositor_create_surface(state.compositor);
+		assert(output->surface);
+
+		output->input_region = wl_compositor_create_region(state.compositor);
+		assert(output->input_region);
+		wl_surface_set_input_region(output->surface, output->input_region);
+
+		output->layer_surface = zwlr_layer_shell_v1_get_layer_surface(
+				state.layer_shell, output->surface, output->output,
+				ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND, "wallpaper");
+		assert(output->layer_surface);
+
+		zwlr_layer_surface_v1_set_size(output->layer_surface, 0, 0);
+		zwlr_layer_surface_v1_set_anchor(output->layer_surface,
+				ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP |
+				ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT |
+				ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM |
+				ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT);
+		zwlr_layer_surface_v1_set_exclusive_zone(output->layer_surface, -1);
+		zwlr_layer_surface_v1_add_listener(output->layer_surface,
+				&layer_surface_listener, output);
+		wl_surface_commit(output->surface);
+	}
 	wl_display_roundtrip(state.display);
 
-	state.run_display = true;
-	while (wl_display_dispatch(state.display) != -1 && state.run_display) {
+	state.run_display = !wl_list_empty(&state.outputs);
+	while (state.run_display && wl_display_dispatch(state.display) != -1) {
 		// This space intentionally left blank
 	}
 	return 0;
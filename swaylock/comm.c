@@ -0,0 +1,142 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <wlr/util/log.h>
+#include "swaylock/swaylock.h"
+
+/**
+ * Passwords are checked in a child process, which reads requests from
+ * comm[0] and writes replies to comm[1]. The main process watches the
+ * reply pipe in its event loop, so it keeps drawing and taking input while
+ * a check is running.
+ */
+static int comm[2][2] = {{-1, -1}, {-1, -1}};
+static pid_t child_pid = -1;
+
+void clear_buffer(void *buf, size_t bytes) {
+	volatile char *buffer = buf;
+	volatile char zero = '\0';
+	for (size_t i = 0; i < bytes; ++i) {
+		buffer[i] = zero;
+	}
+}
+
+ssize_t read_comm_request(char **buf_ptr) {
+	size_t size;
+	ssize_t amt;
+	amt = read(comm[0][0], &size, sizeof(size));
+	if (amt == 0) {
+		return 0;
+	} else if (amt < 0) {
+		wlr_log_errno(WLR_ERROR, "read pw request");
+		return -1;
+	}
+	wlr_log(WLR_DEBUG, "received pw check request");
+	char *buf = malloc(size);
+	if (!buf) {
+		wlr_log_errno(WLR_ERROR, "failed to malloc pw buffer");
+		return -1;
+	}
+	size_t offs = 0;
+	do {
+		amt = read(comm[0][0], &buf[offs], size - offs);
+		if (amt <= 0) {
+			wlr_log_errno(WLR_ERROR, "failed to read pw");
+			clear_buffer(buf, offs);
+			free(buf);
+			return -1;
+		}
+		offs += (size_t)amt;
+	} while (offs < size);
+	*buf_ptr = buf;
+	return size;
+}
+
+bool write_comm_reply(bool success) {
+	if (write(comm[1][1], &success, sizeof(success)) != sizeof(success)) {
+		wlr_log_errno(WLR_ERROR, "failed to write pw check result");
+		return false;
+	}
+	return true;
+}
+
+bool spawn_comm_child(void) {
+	if (pipe(comm[0]) != 0) {
+		wlr_log_errno(WLR_ERROR, "failed to create pipe");
+		return false;
+	}
+	if (pipe(comm[1]) != 0) {
+		wlr_log_errno(WLR_ERROR, "failed to create pipe");
+		return false;
+	}
+	child_pid = fork();
+	if (child_pid == 0) {
+		close(comm[0][1]);
+		close(comm[1][0]);
+		run_pw_backend_child();
+	} else if (child_pid < 0) {
+		wlr_log_errno(WLR_ERROR, "failed to fork");
+		return false;
+	}
+	close(comm[0][0]);
+	close(comm[1][1]);
+	// A dead child must not take the locker down with it
+	signal(SIGPIPE, SIG_IGN);
+	return true;
+}
+
+bool respawn_comm_child(void) {
+	close(comm[0][1]);
+	close(comm[1][0]);
+	comm[0][1] = comm[1][0] = -1;
+	if (child_pid > 0) {
+		// It has closed its end of the pipe, so it is exiting if not gone
+		kill(child_pid, SIGTERM);
+		waitpid(child_pid, NULL, 0);
+		child_pid = -1;
+	}
+	return spawn_comm_child();
+}
+
+bool write_comm_request(struct swaylock_password *pw) {
+	bool result = false;
+	size_t len = pw->len + 1;
+	size_t offs = 0;
+	if (write(comm[0][1], &len, sizeof(len)) < 0) {
+		wlr_log_errno(WLR_ERROR, "Failed to request pw check");
+		goto out;
+	}
+	do {
+		ssize_t amt = write(comm[0][1], &pw->buffer[offs], len - offs);
+		if (amt < 0) {
+			wlr_log_errno(WLR_ERROR, "Failed to write pw buffer");
+			goto out;
+		}
+		offs += amt;
+	} while (offs < len);
+	result = true;
+out:
+	clear_password_buffer(pw);
+	return result;
+}
+
+int read_comm_reply(void) {
+	bool result = false;
+	ssize_t amt = read(comm[1][0], &result, sizeof(result));
+	if (amt == 0) {
+		return -1;
+	} else if (amt != sizeof(result)) {
+		wlr_log_errno(WLR_ERROR, "Failed to read pw result");
+		return -1;
+	}
+	wlr_log(WLR_DEBUG, "pw result: %d", result);
+	return result;
+}
+
+int get_comm_reply_fd(void) {
+	return comm[1][0];
+}
@@ -2,8 +2,10 @@
 #define _POSIX_C_SOURCE 200112L
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,6 +23,7 @@
 #include "pool-buffer.h"
 #include "cairo.h"
 #include "log.h"
+#include "loop.h"
 #include "readline.h"
 #include "stringop.h"
 #include "util.h"
@@ -72,11 +75,19 @@ static void destroy_surface(struct swaylock_surface *surface) {
 	if (surface->layer_surface != NULL) {
 		zwlr_layer_surface_v1_destroy(surface->layer_surface);
 	}
+	if (surface->subsurface != NULL) {
+		wl_subsurface_destroy(surface->subsurface);
+	}
+	if (surface->child != NULL) {
+		wl_surface_destroy(surface->child);
+	}
 	if (surface->surface != NULL) {
 		wl_surface_destroy(surface->surface);
 	}
-	destroy_buffer(&surface->buffers[0]);
-	destroy_buffer(&surface->buffers[1]);
+	for (size_t i = 0; i < POOL_BUFFER_COUNT; ++i) {
+		destroy_buffer(&surface->buffers[i]);
+		destroy_buffer(&surface->indicator_buffers[i]);
+	}
 	wl_output_destroy(surface->output);
 	free(surface);
 }
@@ -101,6 +112,15 @@ static void create_layer_surface(struct swaylock_surface *surface) {
 	surface->surface = wl_compositor_create_surface(state->compositor);
 	assert(surface->surface);
 
+	// The indicator is drawn into a subsurface on top of the background, so
+	// that input only redraws the indicator
+	surface->child = wl_compositor_create_surface(state->compositor);
+	assert(surface->child);
+	surface->subsurface = wl_subcompositor_get_subsurface(
+			state->subcompositor, surface->child, surface->surface);
+	assert(surface->subsurface);
+	wl_subsurface_set_desync(surface->subsurface);
+
 	surface->layer_surface = zwlr_layer_shell_v1_get_layer_surface(
 			state->layer_shell, surface->surface, surface->output,
 			ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY, "lockscreen");
@@ -163,7 +183,7 @@ static void surface_frame_handle_done(void *data, struct wl_callback *callback,
 
 	if (surface->dirty) {
 		// Schedule a frame in case the surface is damaged again
-		struct wl_callback *callback = wl_surface_frame(surface->surface);
+		struct wl_callback *callback = wl_surface_frame(surface->child);
 		wl_callback_add_listener(callback, &surface_frame_listener, surface);
 		surface->frame_pending = true;
 
@@ -182,10 +202,10 @@ void damage_surface(struct swaylock_surface *surface) {
 		return;
 	}
 
-	struct wl_callback *callback = wl_surface_frame(surface->surface);
+	struct wl_callback *callback = wl_surface_frame(surface->child);
 	wl_callback_add_listener(callback, &surface_frame_listener, surface);
 	surface->frame_pending = true;
-	wl_surface_commit(surface->surface);
+	wl_surface_commit(surface->child);
 }
 
 void damage_state(struct swaylock_state *state) {
@@ -272,6 +292,9 @@ static void handle_global(void *data, struct wl_registry *registry,
 	if (strcmp(interface, wl_compositor_interface.name) == 0) {
 		state->compositor = wl_registry_bind(registry, name,
 				&wl_compositor_interface, 3);
+	} else if (strcmp(interface, wl_subcompositor_interface.name) == 0) {
+		state->subcompositor = wl_registry_bind(registry, name,
+				&wl_subcompositor_interface, 1);
 	} else if (strcmp(interface, wl_shm_interface.name) == 0) {
 		state->shm = wl_registry_bind(registry, name,
 				&wl_shm_interface, 1);
@@ -844,6 +867,46 @@ static int load_config(char *path, struct swaylock_state *state,
 
 static struct swaylock_state state;
 
+static void display_in(int fd, short mask, void *data) {
+	if (wl_display_dispatch(state.display) == -1) {
+		state.run_display = false;
+	}
+}
+
+// Consecutive restarts of the password checking child without a reply
+#define MAX_COMM_RESPAWNS 3
+
+static void comm_in(int fd, short mask, void *data) {
+	static int respawns = 0;
+	int reply = read_comm_reply();
+	if (reply == 1) {
+		// Authentication succeeded
+		state.run_display = false;
+		return;
+	} else if (reply == 0) {
+		respawns = 0;
+		state.auth_state = AUTH_STATE_INVALID;
+		damage_state(&state);
+		return;
+	}
+
+	// The child is gone. That isn't the user's fault, so the attempt in
+	// progress is dropped rather than shown as a wrong password.
+	wlr_log(WLR_ERROR, "Password checking subprocess exited unexpectedly");
+	loop_remove_fd(state.eventloop, fd);
+	state.auth_state = AUTH_STATE_CLEAR;
+	damage_state(&state);
+	if (++respawns > MAX_COMM_RESPAWNS) {
+		wlr_log(WLR_ERROR, "Password checking subprocess keeps failing, "
+				"giving up");
+		return;
+	}
+	if (respawn_comm_child()) {
+		loop_add_fd(state.eventloop, get_comm_reply_fd(), POLLIN,
+				comm_in, NULL);
+	}
+}
+
 int main(int argc, char **argv) {
 	wlr_log_init(WLR_DEBUG, NULL);
 	initialize_pw_backend();
@@ -908,7 +971,8 @@ int main(int argc, char **argv) {
 	struct wl_registry *registry = wl_display_get_registry(state.display);
 	wl_registry_add_listener(registry, &registry_listener, &state);
 	wl_display_roundtrip(state.display);
-	assert(state.compositor && state.layer_shell && state.shm);
+	assert(state.compositor && state.subcompositor && state.layer_shell &&
+			state.shm);
 	if (!state.input_inhibit_manager) {
 		wlr_log(WLR_ERROR, "Compositor does not support the input inhibitor "
 				"protocol, refusing to run insecurely");
@@ -946,11 +1010,21 @@ int main(int argc, char **argv) {
 		daemonize();
 	}
 
+	state.eventloop = loop_create();
+	loop_add_fd(state.eventloop, wl_display_get_fd(state.display), POLLIN,
+			display_in, NULL);
+	loop_add_fd(state.eventloop, get_comm_reply_fd(), POLLIN, comm_in, NULL);
+
 	state.run_display = true;
-	while (wl_display_dispatch(state.display) != -1 && state.run_display) {
-		// This space intentionally left blank
+	while (state.run_display) {
+		errno = 0;
+		if (wl_display_flush(state.display) == -1 && errno != EAGAIN) {
+			break;
+		}
+		loop_poll(state.eventloop);
 	}
 
+	loop_destroy(state.eventloop);
 	free(state.args.font);
 	return 0;
 }
@@ -8,22 +8,33 @@
 #include <wlr/util/log.h>
 #include "swaylock/swaylock.h"
 
+static char *pw_buf = NULL;
+
 void initialize_pw_backend(void) {
-	// TODO: only call pam_start once. keep the same handle the whole time
+	if (!spawn_comm_child()) {
+		exit(EXIT_FAILURE);
+	}
 }
 
-static int function_conversation(int num_msg, const struct pam_message **msg,
+static int handle_conversation(int num_msg, const struct pam_message **msg,
 		struct pam_response **resp, void *data) {
-	struct swaylock_password *pw = data;
 	/* PAM expects an array of responses, one for each message */
 	struct pam_response *pam_reply = calloc(
 			num_msg, sizeof(struct pam_response));
+	if (pam_reply == NULL) {
+		wlr_log(WLR_ERROR, "Allocation failed");
+		return PAM_ABORT;
+	}
 	*resp = pam_reply;
 	for (int i = 0; i < num_msg; ++i) {
 		switch (msg[i]->msg_style) {
 		case PAM_PROMPT_ECHO_OFF:
 		case PAM_PROMPT_ECHO_ON:
-			pam_reply[i].resp = strdup(pw->buffer); // PAM clears and frees this
+			pam_reply[i].resp = strdup(pw_buf); // PAM clears and frees this
+			if (pam_reply[i].resp == NULL) {
+				wlr_log(WLR_ERROR, "Allocation failed");
+				return PAM_ABORT;
+			}
 			break;
 		case PAM_ERROR_MSG:
 		case PAM_TEXT_INFO:
@@ -33,30 +44,59 @@ static int function_conversation(int num_msg, const struct pam_message **msg,
 	return PAM_SUCCESS;
 }
 
-bool attempt_password(struct swaylock_password *pw) {
+void run_pw_backend_child(void) {
 	struct passwd *passwd = getpwuid(getuid());
+	if (!passwd) {
+		wlr_log_errno(WLR_ERROR, "getpwuid failed");
+		exit(EXIT_FAILURE);
+	}
+
 	char *username = passwd->pw_name;
-	const struct pam_conv local_conversation = {
-		function_conversation, pw
+	const struct pam_conv conv = {
+		.conv = handle_conversation,
+		.appdata_ptr = NULL,
 	};
-	pam_handle_t *local_auth_handle = NULL;
-	int pam_err;
-	if ((pam_err = pam_start("swaylock", username,
-					&local_conversation, &local_auth_handle)) != PAM_SUCCESS) {
-		wlr_log(WLR_ERROR, "PAM returned error %d", pam_err);
+	pam_handle_t *auth_handle = NULL;
+	if (pam_start("swaylock", username, &conv, &auth_handle) != PAM_SUCCESS) {
+		wlr_log(WLR_ERROR, "pam_start failed");
+		exit(EXIT_FAILURE);
 	}
-	if ((pam_err = pam_authenticate(local_auth_handle, 0)) != PAM_SUCCESS) {
-		wlr_log(WLR_ERROR, "pam_authenticate failed");
-		goto fail;
+
+	/* This code does not run as root */
+	wlr_log(WLR_DEBUG, "Prepared to authorize user %s", username);
+
+	int pam_status = PAM_SUCCESS;
+	while (1) {
+		ssize_t size = read_comm_request(&pw_buf);
+		if (size < 0) {
+			exit(EXIT_FAILURE);
+		} else if (size == 0) {
+			break;
+		}
+
+		pam_status = pam_authenticate(auth_handle, 0);
+		bool success = pam_status == PAM_SUCCESS;
+		if (!success) {
+			wlr_log(WLR_ERROR, "pam_authenticate failed");
+		}
+
+		clear_buffer(pw_buf, size);
+		free(pw_buf);
+		pw_buf = NULL;
+
+		if (!write_comm_reply(success)) {
+			exit(EXIT_FAILURE);
+		}
+		if (success) {
+			/* Unlocking is final, so there is no point in staying around */
+			break;
+		}
 	}
-	// TODO: only call pam_end once we succeed at authing. refresh tokens beforehand
-	if ((pam_err = pam_end(local_auth_handle, pam_err)) != PAM_SUCCESS) {
+
+	pam_setcred(auth_handle, PAM_REFRESH_CRED);
+	if (pam_end(auth_handle, pam_status) != PAM_SUCCESS) {
 		wlr_log(WLR_ERROR, "pam_end failed");
-		goto fail;
+		exit(EXIT_FAILURE);
 	}
-	clear_password_buffer(pw);
-	return true;
-fail:
-	clear_password_buffer(pw);
-	return false;
+	exit(EXIT_SUCCESS);
 }
@@ -10,13 +10,12 @@
 #include "swaylock/seat.h"
 #include "unicode.h"
 
+#define VERIFY_REDRAW_INTERVAL 50 // ms
+
+static void schedule_verify_redraw(struct swaylock_state *state);
+
 void clear_password_buffer(struct swaylock_password *pw) {
-	// Use volatile keyword so so compiler can't optimize this out.
-	volatile char *buffer = pw->buffer;
-	volatile char zero = '\0';
-	for (size_t i = 0; i < sizeof(buffer); ++i) {
-		buffer[i] = zero;
-	}
+	clear_buffer(pw->buffer, sizeof(pw->buffer));
 	pw->len = 0;
 }
 
@@ -39,6 +38,36 @@ static void append_ch(struct swaylock_password *pw, uint32_t codepoint) {
 	pw->len += utf8_size;
 }
 
+static void handle_verify_timer(void *data) {
+	struct swaylock_state *state = data;
+	state->verify_timer = NULL;
+	if (state->auth_state == AUTH_STATE_VALIDATING) {
+		damage_state(state);
+		schedule_verify_redraw(state);
+	}
+}
+
+/**
+ * Keeps the indicator animating while a password is being checked.
+ */
+static void schedule_verify_redraw(struct swaylock_state *state) {
+	if (state->verify_timer || !state->eventloop) {
+		return;
+	}
+	state->verify_timer = loop_add_timer(state->eventloop,
+			VERIFY_REDRAW_INTERVAL, handle_verify_timer, state);
+}
+
+static void set_input_state(struct swaylock_state *state,
+		enum auth_state auth_state) {
+	// Input typed during validation goes to the next attempt, but the
+	// indicator keeps showing the one in progress
+	if (state->auth_state != AUTH_STATE_VALIDATING) {
+		state->auth_state = auth_state;
+	}
+	damage_state(state);
+}
+
 void swaylock_handle_key(struct swaylock_state *state,
 		xkb_keysym_t keysym, uint32_t codepoint) {
 	switch (keysym) {
@@ -48,49 +77,37 @@ void swaylock_handle_key(struct swaylock_state *state,
 			break;
 		}
 
-		state->auth_state = AUTH_STATE_VALIDATING;
-		damage_state(state);
-		while (wl_display_dispatch(state->display) != -1 && state->run_display) {
-			bool ok = 1;
-			struct swaylock_surface *surface;
-			wl_list_for_each(surface, &state->surfaces, link) {
-				if (surface->dirty) {
-					ok = 0;
-				}
-			}
-			if (ok) {
-				break;
-			}
+		if (state->auth_state == AUTH_STATE_VALIDATING) {
+			// The previous attempt is still being checked
+			break;
 		}
-		wl_display_flush(state->display);
 
-		if (attempt_password(&state->password)) {
-			state->run_display = false;
+		if (!write_comm_request(&state->password)) {
+			state->auth_state = AUTH_STATE_INVALID;
+			damage_state(state);
 			break;
 		}
-		state->auth_state = AUTH_STATE_INVALID;
+		state->auth_state = AUTH_STATE_VALIDATING;
 		damage_state(state);
+		schedule_verify_redraw(state);
 		break;
 	case XKB_KEY_Delete:
 	case XKB_KEY_BackSpace:
 		if (backspace(&state->password)) {
-			state->auth_state = AUTH_STATE_BACKSPACE;
+			set_input_state(state, AUTH_STATE_BACKSPACE);
 		} else {
-			state->auth_state = AUTH_STATE_CLEAR;
+			set_input_state(state, AUTH_STATE_CLEAR);
 		}
-		damage_state(state);
 		break;
 	case XKB_KEY_Escape:
 		clear_password_buffer(&state->password);
-		state->auth_state = AUTH_STATE_CLEAR;
-		damage_state(state);
+		set_input_state(state, AUTH_STATE_CLEAR);
 		break;
 	case XKB_KEY_Caps_Lock:
 		/* The state is getting active after this
 		 * so we need to manually toggle it */
 		state->xkb.caps_lock = !state->xkb.caps_lock;
-		state->auth_state = AUTH_STATE_INPUT_NOP;
-		damage_state(state);
+		set_input_state(state, AUTH_STATE_INPUT_NOP);
 		break;
 	case XKB_KEY_Shift_L:
 	case XKB_KEY_Shift_R:
@@ -102,22 +119,19 @@ void swaylock_handle_key(struct swaylock_state *state,
 	case XKB_KEY_Alt_R:
 	case XKB_KEY_Super_L:
 	case XKB_KEY_Super_R:
-		state->auth_state = AUTH_STATE_INPUT_NOP;
-		damage_state(state);
+		set_input_state(state, AUTH_STATE_INPUT_NOP);
 		break;
 	case XKB_KEY_u:
 		if (state->xkb.control) {
 			clear_password_buffer(&state->password);
-			state->auth_state = AUTH_STATE_CLEAR;
-			damage_state(state);
+			set_input_state(state, AUTH_STATE_CLEAR);
 			break;
 		}
 		// fallthrough
 	default:
 		if (codepoint) {
 			append_ch(&state->password, codepoint);
-			state->auth_state = AUTH_STATE_INPUT;
-			damage_state(state);
+			set_input_state(state, AUTH_STATE_INPUT);
 		}
 		break;
 	}
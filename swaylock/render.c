@@ -1,6 +1,7 @@
 #define _POSIX_C_SOURCE 199506L
 #include <math.h>
 #include <stdlib.h>
+#include <time.h>
 #include <wayland-client.h>
 #include "cairo.h"
 #include "background-image.h"
@@ -23,14 +24,24 @@ static void set_color_for_state(cairo_t *cairo, struct swaylock_state *state,
 	}
 }
 
-void render_frame(struct swaylock_surface *surface) {
+/**
+ * The indicator lives in its own subsurface, which is all that needs to be
+ * redrawn on input. Returns its size in surface-local coordinates.
+ */
+static int get_indicator_size(struct swaylock_state *state) {
+	// Leave room for the outer border around the ring
+	return 2 * (state->args.radius + state->args.thickness / 2 + 2);
+}
+
+/**
+ * Draws the background into the main surface. It is only redrawn when the
+ * output's size or scale changes.
+ */
+static void render_background(struct swaylock_surface *surface) {
 	struct swaylock_state *state = surface->state;
 
 	int buffer_width = surface->width * surface->scale;
 	int buffer_height = surface->height * surface->scale;
-	if (buffer_width == 0 || buffer_height == 0) {
-		return; // not yet configured
-	}
 
 	surface->current_buffer = get_next_buffer(state->shm,
 			surface->buffers, buffer_width, buffer_height);
@@ -39,15 +50,7 @@ void render_frame(struct swaylock_surface *surface) {
 	}
 
 	cairo_t *cairo = surface->current_buffer->cairo;
-	cairo_set_antialias(cairo, CAIRO_ANTIALIAS_BEST);
-	cairo_font_options_t *fo = cairo_font_options_create();
-	cairo_font_options_set_hint_style(fo, CAIRO_HINT_STYLE_FULL);
-	cairo_font_options_set_antialias(fo, CAIRO_ANTIALIAS_SUBPIXEL);
-	cairo_font_options_set_subpixel_order(fo, to_cairo_subpixel_order(surface->subpixel));
-	cairo_set_font_options(cairo, fo);
-	cairo_font_options_destroy(fo);
 	cairo_identity_matrix(cairo);
-
 	cairo_save(cairo);
 	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
 	if (state->args.mode == BACKGROUND_MODE_SOLID_COLOR || !surface->image) {
@@ -58,8 +61,52 @@ void render_frame(struct swaylock_surface *surface) {
 				state->args.mode, buffer_width, buffer_height);
 	}
 	cairo_restore(cairo);
+
+	// The position is applied with the parent's next commit
+	int indicator_size = get_indicator_size(state);
+	wl_subsurface_set_position(surface->subsurface,
+			((int)surface->width - indicator_size) / 2,
+			((int)surface->height - indicator_size) / 2);
+
+	wl_surface_set_buffer_scale(surface->surface, surface->scale);
+	wl_surface_attach(surface->surface, surface->current_buffer->buffer, 0, 0);
+	wl_surface_damage(surface->surface, 0, 0, surface->width, surface->height);
+	wl_surface_commit(surface->surface);
+
+	surface->background_width = surface->width;
+	surface->background_height = surface->height;
+	surface->background_scale = surface->scale;
+}
+
+static void render_indicator(struct swaylock_surface *surface) {
+	struct swaylock_state *state = surface->state;
+
+	int indicator_size = get_indicator_size(state);
+	int buffer_size = indicator_size * surface->scale;
+	int center = buffer_size / 2;
+
+	struct pool_buffer *buffer = get_next_buffer(state->shm,
+			surface->indicator_buffers, buffer_size, buffer_size);
+	if (buffer == NULL) {
+		return;
+	}
+
+	cairo_t *cairo = buffer->cairo;
+	cairo_set_antialias(cairo, CAIRO_ANTIALIAS_BEST);
+	cairo_font_options_t *fo = cairo_font_options_create();
+	cairo_font_options_set_hint_style(fo, CAIRO_HINT_STYLE_FULL);
+	cairo_font_options_set_antialias(fo, CAIRO_ANTIALIAS_SUBPIXEL);
+	cairo_font_options_set_subpixel_order(fo, to_cairo_subpixel_order(surface->subpixel));
+	cairo_set_font_options(cairo, fo);
+	cairo_font_options_destroy(fo);
 	cairo_identity_matrix(cairo);
 
+	// Clear to transparent, the background shows through from below
+	cairo_save(cairo);
+	cairo_set_operator(cairo, CAIRO_OPERATOR_CLEAR);
+	cairo_paint(cairo);
+	cairo_restore(cairo);
+
 	int arc_radius = state->args.radius * surface->scale;
 	int arc_thickness = state->args.thickness * surface->scale;
 	float type_indicator_border_thickness =
@@ -68,8 +115,7 @@ void render_frame(struct swaylock_surface *surface) {
 	if (state->args.show_indicator && state->auth_state != AUTH_STATE_IDLE) {
 		// Draw circle
 		cairo_set_line_width(cairo, arc_thickness);
-		cairo_arc(cairo, buffer_width / 2, buffer_height / 2, arc_radius,
-				0, 2 * M_PI);
+		cairo_arc(cairo, center, center, arc_radius, 0, 2 * M_PI);
 		set_color_for_state(cairo, state, &state->args.colors.inside);
 		cairo_fill_preserve(cairo);
 		set_color_for_state(cairo, state, &state->args.colors.ring);
@@ -105,10 +151,8 @@ void render_frame(struct swaylock_surface *surface) {
 			cairo_text_extents_t extents;
 			double x, y;
 			cairo_text_extents(cairo, text, &extents);
-			x = (buffer_width / 2) -
-				(extents.width / 2 + extents.x_bearing);
-			y = (buffer_height / 2) -
-				(extents.height / 2 + extents.y_bearing);
+			x = center - (extents.width / 2 + extents.x_bearing);
+			y = center - (extents.height / 2 + extents.y_bearing);
 
 			cairo_move_to(cairo, x, y);
 			cairo_show_text(cairo, text);
@@ -122,7 +166,7 @@ void render_frame(struct swaylock_surface *surface) {
 			static double highlight_start = 0;
 			highlight_start +=
 				(rand() % (int)(M_PI * 100)) / 100.0 + M_PI * 0.5;
-			cairo_arc(cairo, buffer_width / 2, buffer_height / 2,
+			cairo_arc(cairo, center, center,
 					arc_radius, highlight_start,
 					highlight_start + TYPE_INDICATOR_RANGE);
 			if (state->auth_state == AUTH_STATE_INPUT) {
@@ -134,33 +178,57 @@ void render_frame(struct swaylock_surface *surface) {
 
 			// Draw borders
 			cairo_set_source_u32(cairo, state->args.colors.separator);
-			cairo_arc(cairo, buffer_width / 2, buffer_height / 2,
+			cairo_arc(cairo, center, center,
 					arc_radius, highlight_start,
 					highlight_start + type_indicator_border_thickness);
 			cairo_stroke(cairo);
 
-			cairo_arc(cairo, buffer_width / 2, buffer_height / 2,
+			cairo_arc(cairo, center, center,
 					arc_radius, highlight_start + TYPE_INDICATOR_RANGE,
 					highlight_start + TYPE_INDICATOR_RANGE +
 						type_indicator_border_thickness);
 			cairo_stroke(cairo);
 		}
 
+		// Validation indicator: one full turn per second until it's done
+		if (state->auth_state == AUTH_STATE_VALIDATING) {
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			double spin_start = 2 * M_PI * (now.tv_nsec / 1000000000.0);
+			cairo_arc(cairo, center, center,
+					arc_radius, spin_start, spin_start + TYPE_INDICATOR_RANGE);
+			cairo_set_source_u32(cairo, state->args.colors.key_highlight);
+			cairo_stroke(cairo);
+		}
+
 		// Draw inner + outer border of the circle
 		set_color_for_state(cairo, state, &state->args.colors.line);
 		cairo_set_line_width(cairo, 2.0 * surface->scale);
-		cairo_arc(cairo, buffer_width / 2, buffer_height / 2,
+		cairo_arc(cairo, center, center,
 				arc_radius - arc_thickness / 2, 0, 2 * M_PI);
 		cairo_stroke(cairo);
-		cairo_arc(cairo, buffer_width / 2, buffer_height / 2,
+		cairo_arc(cairo, center, center,
 				arc_radius + arc_thickness / 2, 0, 2 * M_PI);
 		cairo_stroke(cairo);
 	}
 
-	wl_surface_set_buffer_scale(surface->surface, surface->scale);
-	wl_surface_attach(surface->surface, surface->current_buffer->buffer, 0, 0);
-	wl_surface_damage(surface->surface, 0, 0, surface->width, surface->height);
-	wl_surface_commit(surface->surface);
+	wl_surface_set_buffer_scale(surface->child, surface->scale);
+	wl_surface_attach(surface->child, buffer->buffer, 0, 0);
+	wl_surface_damage(surface->child, 0, 0, indicator_size, indicator_size);
+	wl_surface_commit(surface->child);
+}
+
+void render_frame(struct swaylock_surface *surface) {
+	if (surface->width == 0 || surface->height == 0) {
+		return; // not yet configured
+	}
+
+	if (surface->background_width != surface->width ||
+			surface->background_height != surface->height ||
+			surface->background_scale != surface->scale) {
+		render_background(surface);
+	}
+	render_indicator(surface);
 }
 
 void render_frames(struct swaylock_state *state) {
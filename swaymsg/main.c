@@ -1,4 +1,6 @@
 #define _XOPEN_SOURCE 500
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -294,9 +296,245 @@ static void pretty_print(int type, json_object *resp) {
 	}
 }
 
+// Commands sent ahead of their replies in batch mode
+#define BATCH_WINDOW 64
+
+static void print_json_line(json_object *obj) {
+	printf("%s\n", json_object_to_json_string_ext(obj, JSON_C_TO_STRING_PLAIN));
+	fflush(stdout);
+}
+
+/**
+ * Waits for the socket and dispatches whatever arrived. Returns false once the
+ * connection is closed.
+ */
+static bool poll_connection(struct ipc_connection *conn) {
+	struct pollfd pfd = {
+		.fd = ipc_connection_get_fd(conn),
+		.events = ipc_connection_poll_events(conn),
+	};
+	if (poll(&pfd, 1, -1) == -1) {
+		return errno == EINTR;
+	}
+	return ipc_connection_dispatch(conn, pfd.revents);
+}
+
+struct monitor_state {
+	const char *filter;
+	bool quiet;
+	bool subscribed;
+	bool failed;
+};
+
+static void handle_subscribe_reply(struct ipc_response *resp, void *data) {
+	struct monitor_state *state = data;
+	json_object *obj = json_tokener_parse(resp->payload);
+	if (!obj || !success_object(obj)) {
+		fprintf(stderr, "Unable to subscribe: %s\n", resp->payload);
+		state->failed = true;
+	}
+	state->subscribed = true;
+	json_object_put(obj);
+}
+
+static void handle_monitor_event(struct ipc_response *event, void *data) {
+	struct monitor_state *state = data;
+	if (state->quiet) {
+		return;
+	}
+	json_object *obj = json_tokener_parse(event->payload);
+	if (!obj) {
+		fprintf(stderr, "ERROR: Could not parse json event from ipc\n");
+		return;
+	}
+	json_object *change;
+	if (!state->filter || (json_object_object_get_ex(obj, "change", &change) &&
+			strcmp(json_object_get_string(change), state->filter) == 0)) {
+		print_json_line(obj);
+	}
+	json_object_put(obj);
+}
+
+/**
+ * Subscribes to the events listed in payload and prints each one on its own
+ * line until sway closes the connection.
+ */
+static int run_monitor(int socketfd, const char *payload, const char *filter,
+		bool quiet) {
+	struct monitor_state state = { .filter = filter, .quiet = quiet };
+	struct ipc_connection *conn =
+		ipc_connection_create(socketfd, handle_monitor_event, &state);
+	if (!conn) {
+		return 1;
+	}
+	if (ipc_connection_send(conn, IPC_SUBSCRIBE, payload, strlen(payload),
+				handle_subscribe_reply, &state)) {
+		while (!state.failed && poll_connection(conn)) {
+			// Events are printed as they arrive
+		}
+	}
+	ipc_connection_destroy(conn);
+	return state.subscribed && !state.failed ? 0 : 1;
+}
+
+struct batch_state {
+	uint32_t type;
+	bool quiet;
+	bool raw;
+	int ret;
+};
+
+static void handle_batch_reply(struct ipc_response *resp, void *data) {
+	struct batch_state *state = data;
+	json_object *obj = json_tokener_parse(resp->payload);
+	if (!obj) {
+		fprintf(stderr, "ERROR: Could not parse json response from ipc. "
+				"This is a bug in sway.\n");
+		state->ret = 1;
+		return;
+	}
+	if (!success(obj, true)) {
+		state->ret = 1;
+	}
+	if (!state->quiet) {
+		if (state->raw) {
+			print_json_line(obj);
+		} else {
+			pretty_print(state->type, obj);
+			fflush(stdout);
+		}
+	}
+	json_object_put(obj);
+}
+
+static bool send_batch_line(struct ipc_connection *conn, char *line,
+		struct batch_state *state) {
+	while (isspace(*line)) {
+		++line;
+	}
+	if (!*line || *line == '#') {
+		return true;
+	}
+	return ipc_connection_send(conn, state->type, line, strlen(line),
+			handle_batch_reply, state);
+}
+
+/**
+ * Sends complete lines from the input buffer while fewer than BATCH_WINDOW
+ * messages are in flight, keeping the rest buffered. At end of input a final
+ * line without a newline is sent too.
+ */
+static bool send_batch_input(struct ipc_connection *conn, char *input,
+		size_t *input_len, bool eof, struct batch_state *state) {
+	if (!*input_len) {
+		return true;
+	}
+	size_t start = 0;
+	bool ok = true;
+	while (ok && start < *input_len &&
+			ipc_connection_pending(conn) < BATCH_WINDOW) {
+		char *line = input + start;
+		char *newline = memchr(line, '\n', *input_len - start);
+		if (newline) {
+			*newline = '\0';
+			start = newline - input + 1;
+		} else if (eof) {
+			input[*input_len] = '\0';
+			start = *input_len;
+		} else {
+			break;
+		}
+		ok = send_batch_line(conn, line, state);
+	}
+	memmove(input, input + start, *input_len - start);
+	*input_len -= start;
+	return ok;
+}
+
+/**
+ * Sends each line of stdin as a message over one connection, keeping up to
+ * BATCH_WINDOW of them in flight, and prints the replies in order.
+ */
+static int run_batch(int socketfd, uint32_t type, bool quiet, bool raw) {
+	struct batch_state state = { .type = type, .quiet = quiet, .raw = raw };
+	struct ipc_connection *conn = ipc_connection_create(socketfd, NULL, NULL);
+	if (!conn) {
+		return 1;
+	}
+
+	// stdin is read with read(2) rather than stdio so poll sees every line
+	char *input = NULL;
+	size_t input_len = 0, input_size = 0;
+	bool eof = false, ok = true;
+	while (ok) {
+		ok = send_batch_input(conn, input, &input_len, eof, &state);
+		if (!ok || (eof && !input_len && !ipc_connection_pending(conn))) {
+			break;
+		}
+
+		// Only read more once everything buffered has been sent
+		bool read_input = !eof &&
+			!(input_len && memchr(input, '\n', input_len)) &&
+			ipc_connection_pending(conn) < BATCH_WINDOW;
+		struct pollfd pfds[2] = {
+			{
+				.fd = ipc_connection_get_fd(conn),
+				.events = ipc_connection_poll_events(conn),
+			},
+			{
+				.fd = STDIN_FILENO,
+				.events = POLLIN,
+			},
+		};
+		if (poll(pfds, read_input ? 2 : 1, -1) == -1) {
+			if (errno != EINTR) {
+				ok = false;
+			}
+			continue;
+		}
+		if (pfds[0].revents) {
+			ok = ipc_connection_dispatch(conn, pfds[0].revents);
+		}
+		if (!ok || !read_input || !pfds[1].revents) {
+			continue;
+		}
+
+		if (input_len + 4096 > input_size) {
+			input_size = input_size ? input_size * 2 : 4096;
+			char *new_input = realloc(input, input_size);
+			if (!new_input) {
+				sway_abort("Unable to allocate input buffer");
+			}
+			input = new_input;
+		}
+		// Leave room to terminate a final line without a newline
+		ssize_t n = read(STDIN_FILENO, input + input_len,
+				input_size - input_len - 1);
+		if (n == -1 && errno == EINTR) {
+			continue;
+		} else if (n <= 0) {
+			eof = true;
+		} else {
+			input_len += n;
+		}
+	}
+	free(input);
+
+	if (!ok) {
+		fprintf(stderr, "Lost connection to sway with %d replies outstanding\n",
+				ipc_connection_pending(conn));
+		state.ret = 1;
+	}
+	ipc_connection_destroy(conn);
+	return state.ret;
+}
+
 int main(int argc, char **argv) {
 	static int quiet = 0;
 	static int raw = 0;
+	static int monitor = 0;
+	static int batch = 0;
+	char *filter = NULL;
 	char *socket_path = NULL;
 	char *cmdtype = NULL;
 
@@ -304,6 +542,9 @@ int main(int argc, char **argv) {
 
 	static struct option long_options[] = {
 		{"help", no_argument, NULL, 'h'},
+		{"batch", no_argument, NULL, 'b'},
+		{"filter", required_argument, NULL, 'f'},
+		{"monitor", no_argument, NULL, 'm'},
 		{"quiet", no_argument, NULL, 'q'},
 		{"raw", no_argument, NULL, 'r'},
 		{"socket", required_argument, NULL, 's'},
@@ -316,6 +557,9 @@ int main(int argc, char **argv) {
 		"Usage: swaymsg [options] [message]\n"
 		"\n"
 		"  -h, --help             Show help message and quit.\n"
+		"  -b, --batch            Send each line of stdin as a message.\n"
+		"  -f, --filter <change>  Only print monitored events of this change.\n"
+		"  -m, --monitor          Print subscribed events until sway exits.\n"
 		"  -q, --quiet            Be quiet.\n"
 		"  -r, --raw              Use raw output even if using a tty\n"
 		"  -s, --socket <socket>  Use the specified socket.\n"
@@ -327,11 +571,20 @@ int main(int argc, char **argv) {
 	int c;
 	while (1) {
 		int option_index = 0;
-		c = getopt_long(argc, argv, "hqrs:t:v", long_options, &option_index);
+		c = getopt_long(argc, argv, "hbf:mqrs:t:v", long_options, &option_index);
 		if (c == -1) {
 			break;
 		}
 		switch (c) {
+		case 'b': // Batch
+			batch = 1;
+			break;
+		case 'f': // Filter
+			filter = strdup(optarg);
+			break;
+		case 'm': // Monitor
+			monitor = 1;
+			break;
 		case 'q': // Quiet
 			quiet = 1;
 			break;
@@ -390,12 +643,24 @@ int main(int argc, char **argv) {
 		type = IPC_GET_CONFIG;
 	} else if (strcasecmp(cmdtype, "send_tick") == 0) {
 		type = IPC_SEND_TICK;
+	} else if (strcasecmp(cmdtype, "subscribe") == 0) {
+		type = IPC_SUBSCRIBE;
 	} else {
 		sway_abort("Unknown message type %s", cmdtype);
 	}
 
 	free(cmdtype);
 
+	if (monitor && type != IPC_SUBSCRIBE) {
+		sway_abort("Monitor mode requires a subscribe message");
+	}
+	if (batch && (monitor || type == IPC_SUBSCRIBE)) {
+		sway_abort("Batch mode cannot subscribe to events");
+	}
+	if (batch && optind < argc) {
+		sway_abort("Batch mode reads messages from stdin");
+	}
+
 	char *command = NULL;
 	if (optind < argc) {
 		command = join_args(argv + optind, argc - optind);
@@ -405,6 +670,14 @@ int main(int argc, char **argv) {
 
 	int ret = 0;
 	int socketfd = ipc_open_socket(socket_path);
+	if (monitor || batch) {
+		ret = monitor ? run_monitor(socketfd, command, filter, quiet) :
+			run_batch(socketfd, type, quiet, raw);
+		free(command);
+		free(filter);
+		free(socket_path);
+		return ret;
+	}
 	uint32_t len = strlen(command);
 	char *resp = ipc_single_command(socketfd, type, command, &len);
 	if (!quiet) {
@@ -432,6 +705,7 @@ int main(int argc, char **argv) {
 
 	free(command);
 	free(resp);
+	free(filter);
 	free(socket_path);
 	return ret;
 }
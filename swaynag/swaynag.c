@@ -428,12 +428,8 @@ void swaynag_destroy(struct swaynag *swaynag) {
 		wl_cursor_theme_destroy(swaynag->pointer.cursor_theme);
 	}
 
-	if (&swaynag->buffers[0]) {
-		destroy_buffer(&swaynag->buffers[0]);
-	}
-
-	if (&swaynag->buffers[1]) {
-		destroy_buffer(&swaynag->buffers[1]);
+	for (size_t i = 0; i < POOL_BUFFER_COUNT; ++i) {
+		destroy_buffer(&swaynag->buffers[i]);
 	}
 
 	if (swaynag->outputs.prev || swaynag->outputs.next) {